@@ -0,0 +1,519 @@
+// ============================================================================
+// DSA MICROBENCHMARK
+// ============================================================================
+// Measures the custom containers and sorting routines in dsa.h against their
+// std:: equivalents at 1k, 100k and 1M elements.
+//
+//   hms_bench [maxElements=1000000] [filter]
+//
+// Each row reports throughput (elements per second), heap allocations per
+// element, and p50/p99 latency of one timed call: a single push/pop/lookup
+// for container rows, a whole sort or teardown for the others. Throughput
+// and allocations come from untimed passes after a warm-up run; latencies
+// from separate passes that timestamp every call. Only cases whose name
+// contains `filter` are run.
+
+#include "dsa.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <new>
+#include <queue>
+#include <random>
+#include <stack>
+#include <string>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// ----------------------------------------------------------------------------
+// Allocation counting: every global operator new in this binary is counted
+// ----------------------------------------------------------------------------
+static atomic<uint64_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+// GCC treats operator new's result as coming from the default allocator and
+// flags free() once these deletes are inlined (-Wmismatched-new-delete).
+// The replacements above allocate with malloc, so the pairing is correct.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// ----------------------------------------------------------------------------
+// Timing
+// ----------------------------------------------------------------------------
+// A case does its setup, calls start(), then wraps each measured operation
+// in op(). stop() ends the measured region early, e.g. before teardown.
+class OpClock {
+private:
+    vector<uint32_t>* samples;
+    Clock::time_point begin;
+    Clock::time_point end;
+    uint64_t allocsAtStart;
+    uint64_t allocsAtStop;
+    bool running;
+
+public:
+    explicit OpClock(vector<uint32_t>* latencySamples)
+        : samples(latencySamples), allocsAtStart(0), allocsAtStop(0), running(false) {}
+
+    void start() {
+        running = true;
+        allocsAtStart = allocationCount.load();
+        begin = Clock::now();
+    }
+
+    void stop() {
+        if (!running) return;
+        end = Clock::now();
+        allocsAtStop = allocationCount.load();
+        running = false;
+    }
+
+    template<typename F>
+    void op(F&& f) {
+        if (!samples) {
+            f();
+            return;
+        }
+        auto t0 = Clock::now();
+        f();
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - t0).count();
+        samples->push_back((uint32_t)min<int64_t>(ns, UINT32_MAX));
+    }
+
+    double seconds() const { return chrono::duration<double>(end - begin).count(); }
+    uint64_t allocations() const { return allocsAtStop - allocsAtStart; }
+};
+
+// Runs one implementation at size n; returns the number of elements it
+// processed (the denominator for throughput and allocations)
+using BenchFn = function<size_t(size_t n, OpClock& clock)>;
+
+struct BenchCase {
+    string name;
+    BenchFn custom;
+    BenchFn standard;
+    size_t timedCallsPerElement;    // 0 when a run makes one timed call
+};
+
+struct Measurement {
+    double elementsPerSecond;
+    double allocsPerElement;
+    double p50;
+    double p99;
+};
+
+double percentile(vector<uint32_t>& samples, double p) {
+    if (samples.empty()) return 0.0;
+    size_t idx = min(samples.size() - 1, (size_t)(p * samples.size()));
+    nth_element(samples.begin(), samples.begin() + idx, samples.end());
+    return samples[idx];
+}
+
+Measurement measure(const BenchFn& fn, size_t n, size_t timedCallsPerElement) {
+    Measurement m;
+
+    // One warm-up run, then repeat until at least 200ms have been measured
+    OpClock warmUp(nullptr);
+    fn(n, warmUp);
+    size_t elements = 0;
+    double seconds = 0;
+    uint64_t allocations = 0;
+    do {
+        OpClock throughput(nullptr);
+        elements += fn(n, throughput);
+        throughput.stop();
+        seconds += throughput.seconds();
+        allocations += throughput.allocations();
+    } while (seconds < 0.2);
+    m.elementsPerSecond = elements / max(seconds, 1e-9);
+    m.allocsPerElement = (double)allocations / max<size_t>(elements, 1);
+
+    // Repeat the latency pass until there are enough samples or enough
+    // time has gone by, whichever comes first
+    vector<uint32_t> samples;
+    size_t perRun = timedCallsPerElement ? timedCallsPerElement * n + 16 : 16;
+    auto deadline = Clock::now() + chrono::seconds(2);
+    do {
+        samples.reserve(samples.size() + perRun);
+        OpClock latency(&samples);
+        fn(n, latency);
+        latency.stop();
+    } while (samples.size() < 200 && Clock::now() < deadline);
+
+    m.p50 = percentile(samples, 0.50);
+    m.p99 = percentile(samples, 0.99);
+    return m;
+}
+
+// ----------------------------------------------------------------------------
+// Inputs
+// ----------------------------------------------------------------------------
+vector<uint64_t> randomKeys;
+
+vector<AppointmentRecord> makeAppointments(size_t n) {
+    vector<AppointmentRecord> records(n);
+    mt19937_64 rng(7);
+    for (size_t i = 0; i < n; i++) {
+        records[i].id = to_string(i);
+        records[i].dateTimeKey = 202601010000LL + (int64_t)(rng() % 3650000);
+    }
+    return records;
+}
+
+vector<PatientRecord> makeSortedPatients(size_t n) {
+    vector<PatientRecord> patients(n);
+    char id[25];
+    for (size_t i = 0; i < n; i++) {
+        snprintf(id, sizeof(id), "%024zx", i * 2);
+        patients[i].id = id;
+    }
+    return patients;
+}
+
+struct TriagePriority {
+    uint64_t value;
+    bool operator<(const TriagePriority& other) const { return value < other.value; }
+};
+
+// Max-heap order for the std::priority_queue baseline; a plain functor so
+// the comparison inlines, as it does in MaxHeap
+struct ByPriority {
+    bool operator()(const pair<TriagePriority, uint64_t>& a, const pair<TriagePriority, uint64_t>& b) const {
+        return a.first < b.first;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// Cases
+// ----------------------------------------------------------------------------
+vector<BenchCase> makeCases() {
+    vector<BenchCase> cases;
+
+    cases.push_back({"LinkedList insertAtEnd",
+        [](size_t n, OpClock& clock) {
+            LinkedList<uint64_t> list;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { list.insertAtEnd(randomKeys[i]); });
+            clock.stop();
+            return n;
+        },
+        [](size_t n, OpClock& clock) {
+            std::list<uint64_t> items;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { items.push_back(randomKeys[i]); });
+            clock.stop();
+            return n;
+        }, 1});
+
+    cases.push_back({"LinkedList traverse",
+        [](size_t n, OpClock& clock) {
+            LinkedList<uint64_t> list;
+            for (size_t i = 0; i < n; i++) list.insertAtEnd(randomKeys[i]);
+            volatile uint64_t sum = 0;
+            clock.start();
+            clock.op([&] {
+                uint64_t s = 0;
+                for (uint64_t v : list) s += v;
+                sum = s;
+            });
+            clock.stop();
+            return n;
+        },
+        [](size_t n, OpClock& clock) {
+            std::list<uint64_t> items;
+            for (size_t i = 0; i < n; i++) items.push_back(randomKeys[i]);
+            volatile uint64_t sum = 0;
+            clock.start();
+            clock.op([&] {
+                uint64_t s = 0;
+                for (uint64_t v : items) s += v;
+                sum = s;
+            });
+            clock.stop();
+            return n;
+        }, 0});
+
+    cases.push_back({"LinkedList teardown",
+        [](size_t n, OpClock& clock) {
+            auto list = make_unique<LinkedList<uint64_t>>();
+            for (size_t i = 0; i < n; i++) list->insertAtEnd(randomKeys[i]);
+            clock.start();
+            clock.op([&] { list.reset(); });
+            clock.stop();
+            return n;
+        },
+        [](size_t n, OpClock& clock) {
+            auto list = make_unique<std::list<uint64_t>>();
+            for (size_t i = 0; i < n; i++) list->push_back(randomKeys[i]);
+            clock.start();
+            clock.op([&] { list.reset(); });
+            clock.stop();
+            return n;
+        }, 0});
+
+    cases.push_back({"CustomQueue enqueue+dequeue",
+        [](size_t n, OpClock& clock) {
+            CustomQueue<uint64_t> queue;
+            volatile uint64_t sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { queue.enqueue(randomKeys[i]); });
+            for (size_t i = 0; i < n; i++) clock.op([&] { sink = queue.dequeue(); });
+            clock.stop();
+            return 2 * n;
+        },
+        [](size_t n, OpClock& clock) {
+            std::queue<uint64_t> items;
+            volatile uint64_t sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { items.push(randomKeys[i]); });
+            for (size_t i = 0; i < n; i++) clock.op([&] { sink = items.front(); items.pop(); });
+            clock.stop();
+            return 2 * n;
+        }, 2});
+
+    cases.push_back({"CustomStack push+pop",
+        [](size_t n, OpClock& clock) {
+            CustomStack<uint64_t> stack;
+            volatile uint64_t sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { stack.push(randomKeys[i]); });
+            for (size_t i = 0; i < n; i++) clock.op([&] { sink = stack.pop(); });
+            clock.stop();
+            return 2 * n;
+        },
+        [](size_t n, OpClock& clock) {
+            std::stack<uint64_t> items;
+            volatile uint64_t sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { items.push(randomKeys[i]); });
+            for (size_t i = 0; i < n; i++) clock.op([&] { sink = items.top(); items.pop(); });
+            clock.stop();
+            return 2 * n;
+        }, 2});
+
+    cases.push_back({"BPlusTree insert",
+        [](size_t n, OpClock& clock) {
+            BPlusTree<uint64_t, uint64_t> tree;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { tree.insert(randomKeys[i], i); });
+            clock.stop();
+            return n;
+        },
+        [](size_t n, OpClock& clock) {
+            map<uint64_t, uint64_t> tree;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { tree[randomKeys[i]] = i; });
+            clock.stop();
+            return n;
+        }, 1});
+
+    cases.push_back({"BPlusTree search",
+        [](size_t n, OpClock& clock) {
+            BPlusTree<uint64_t, uint64_t> tree;
+            for (size_t i = 0; i < n; i++) tree.insert(randomKeys[i], i);
+            volatile uint64_t sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) {
+                clock.op([&] {
+                    uint64_t value = 0;
+                    tree.search(randomKeys[(i * 7919) % n], value);
+                    sink = value;
+                });
+            }
+            clock.stop();
+            return n;
+        },
+        [](size_t n, OpClock& clock) {
+            map<uint64_t, uint64_t> tree;
+            for (size_t i = 0; i < n; i++) tree[randomKeys[i]] = i;
+            volatile uint64_t sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) {
+                clock.op([&] { sink = tree.find(randomKeys[(i * 7919) % n])->second; });
+            }
+            clock.stop();
+            return n;
+        }, 1});
+
+    cases.push_back({"BPlusTree range scan (64)",
+        [](size_t n, OpClock& clock) {
+            BPlusTree<uint64_t, uint64_t> tree;
+            for (size_t i = 0; i < n; i++) tree.insert(i, i);
+            volatile uint64_t sink = 0;
+            size_t scans = max<size_t>(1, n / 64);
+            clock.start();
+            for (size_t i = 0; i < scans; i++) {
+                clock.op([&] {
+                    uint64_t from = (i * 7919) % n, s = 0;
+                    tree.scan(from, from + 64, [&](const uint64_t&, const uint64_t& v) { s += v; return true; });
+                    sink = s;
+                });
+            }
+            clock.stop();
+            return scans * 64;
+        },
+        [](size_t n, OpClock& clock) {
+            map<uint64_t, uint64_t> tree;
+            for (size_t i = 0; i < n; i++) tree[i] = i;
+            volatile uint64_t sink = 0;
+            size_t scans = max<size_t>(1, n / 64);
+            clock.start();
+            for (size_t i = 0; i < scans; i++) {
+                clock.op([&] {
+                    uint64_t from = (i * 7919) % n, s = 0;
+                    for (auto it = tree.lower_bound(from); it != tree.end() && it->first < from + 64; ++it) s += it->second;
+                    sink = s;
+                });
+            }
+            clock.stop();
+            return scans * 64;
+        }, 1});
+
+    cases.push_back({"MaxHeap insert+extractMax",
+        [](size_t n, OpClock& clock) {
+            MaxHeap<uint64_t, TriagePriority> heap;
+            volatile uint64_t sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { heap.insert(i, {randomKeys[i]}); });
+            for (size_t i = 0; i < n; i++) clock.op([&] { sink = heap.extractMax().second.value; });
+            clock.stop();
+            return 2 * n;
+        },
+        [](size_t n, OpClock& clock) {
+            priority_queue<pair<TriagePriority, uint64_t>, vector<pair<TriagePriority, uint64_t>>, ByPriority> heap;
+            volatile uint64_t sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) clock.op([&] { heap.push({{randomKeys[i]}, i}); });
+            for (size_t i = 0; i < n; i++) clock.op([&] { sink = heap.top().first.value; heap.pop(); });
+            clock.stop();
+            return 2 * n;
+        }, 2});
+
+    cases.push_back({"quickSort (uint64)",
+        [](size_t n, OpClock& clock) {
+            vector<uint64_t> data(randomKeys.begin(), randomKeys.begin() + n);
+            clock.start();
+            clock.op([&] { quickSort(data, 0, (int)data.size() - 1); });
+            clock.stop();
+            return n;
+        },
+        [](size_t n, OpClock& clock) {
+            vector<uint64_t> data(randomKeys.begin(), randomKeys.begin() + n);
+            clock.start();
+            clock.op([&] { sort(data.begin(), data.end()); });
+            clock.stop();
+            return n;
+        }, 0});
+
+    cases.push_back({"mergeSort (appointments)",
+        [](size_t n, OpClock& clock) {
+            auto records = makeAppointments(n);
+            vector<AppointmentRecord> scratch(n / 2 + 1);
+            clock.start();
+            clock.op([&] { mergeSort(records, 0, (int)records.size() - 1, scratch); });
+            clock.stop();
+            return n;
+        },
+        [](size_t n, OpClock& clock) {
+            auto records = makeAppointments(n);
+            clock.start();
+            clock.op([&] {
+                stable_sort(records.begin(), records.end(), [](const AppointmentRecord& a, const AppointmentRecord& b) {
+                    return a.dateTimeKey < b.dateTimeKey;
+                });
+            });
+            clock.stop();
+            return n;
+        }, 0});
+
+    cases.push_back({"binarySearch (patients)",
+        [](size_t n, OpClock& clock) {
+            auto patients = makeSortedPatients(n);
+            volatile int sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) {
+                clock.op([&] { sink = binarySearch(patients, patients[(i * 7919) % n].id); });
+            }
+            clock.stop();
+            return n;
+        },
+        [](size_t n, OpClock& clock) {
+            auto patients = makeSortedPatients(n);
+            volatile int sink = 0;
+            clock.start();
+            for (size_t i = 0; i < n; i++) {
+                clock.op([&] {
+                    const string& id = patients[(i * 7919) % n].id;
+                    auto it = lower_bound(patients.begin(), patients.end(), id,
+                                          [](const PatientRecord& p, const string& key) { return p.id < key; });
+                    sink = (it != patients.end() && it->id == id) ? (int)(it - patients.begin()) : -1;
+                });
+            }
+            clock.stop();
+            return n;
+        }, 1});
+
+    return cases;
+}
+
+void printRow(const string& name, size_t n, const string& impl, const Measurement& m) {
+    printf("%-28s %8zu  %-6s %12.2f %10.3f %10.0f %10.0f\n",
+           name.c_str(), n, impl.c_str(), m.elementsPerSecond / 1e6, m.allocsPerElement, m.p50, m.p99);
+}
+
+int main(int argc, char** argv) {
+    size_t maxElements = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    string filter = argc > 2 ? argv[2] : "";
+    if (maxElements == 0) {
+        fprintf(stderr, "usage: hms_bench [maxElements] [filter]\n");
+        return 2;
+    }
+
+    mt19937_64 rng(42);
+    randomKeys.resize(maxElements);
+    for (auto& key : randomKeys) key = rng();
+
+    printf("%-28s %8s  %-6s %12s %10s %10s %10s\n",
+           "case", "n", "impl", "Melem/s", "allocs/el", "p50 ns", "p99 ns");
+
+    for (auto& benchCase : makeCases()) {
+        if (!filter.empty() && benchCase.name.find(filter) == string::npos) continue;
+        for (size_t n : {(size_t)1000, (size_t)100000, (size_t)1000000}) {
+            if (n > maxElements) break;
+            printRow(benchCase.name, n, "custom", measure(benchCase.custom, n, benchCase.timedCallsPerElement));
+            printRow(benchCase.name, n, "std", measure(benchCase.standard, n, benchCase.timedCallsPerElement));
+        }
+    }
+    return 0;
+}
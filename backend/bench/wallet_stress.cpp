@@ -0,0 +1,210 @@
+// ============================================================================
+// WALLET CONCURRENCY STRESS BENCHMARK
+// ============================================================================
+// Hammers POST /api/wallet on one wallet from many threads against a running
+// hms_server and checks that no update was lost and no debit overdrew it.
+//
+//   hms_wallet_stress <userId> [threads=16] [opsPerThread=500] [host=127.0.0.1] [port=8080]
+//
+// Crediting a wallet needs an admin or receptionist session. Pass its token in
+// HMS_TOKEN, or set HMS_EMAIL and HMS_PASSWORD to log in before the run.
+//
+// Phase 1 mixes credits and debits of 1.00; the final balance must equal
+// start + successful credits - successful debits. Phase 2 has every thread
+// debit until rejected; the wallet must end at exactly start - successes
+// and never below zero.
+
+#include <asio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using asio::ip::tcp;
+
+struct HttpResult {
+    int status;
+    string body;
+};
+
+// Bearer token sent with every request; set once before the workers start
+string authToken;
+
+HttpResult httpRequest(const string& host, const string& port, const string& method,
+                       const string& path, const string& body) {
+    asio::io_context io;
+    tcp::resolver resolver(io);
+    tcp::socket socket(io);
+    asio::connect(socket, resolver.resolve(host, port));
+
+    string request = method + " " + path + " HTTP/1.1\r\n"
+        "Host: " + host + "\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: " + to_string(body.size()) + "\r\n" +
+        (authToken.empty() ? "" : "Authorization: Bearer " + authToken + "\r\n") +
+        "Connection: close\r\n\r\n" + body;
+    asio::write(socket, asio::buffer(request));
+
+    string response;
+    asio::error_code ec;
+    char buf[4096];
+    while(true) {
+        size_t n = socket.read_some(asio::buffer(buf), ec);
+        response.append(buf, n);
+        if(ec) break;
+    }
+
+    HttpResult result;
+    result.status = atoi(response.substr(response.find(' ') + 1, 3).c_str());
+    size_t bodyStart = response.find("\r\n\r\n");
+    result.body = bodyStart == string::npos ? "" : response.substr(bodyStart + 4);
+    return result;
+}
+
+// Pulls a string field out of a flat JSON response body
+string jsonStringField(const string& body, const string& field) {
+    size_t pos = body.find("\"" + field + "\"");
+    if(pos == string::npos) return "";
+    pos = body.find('"', body.find(':', pos));
+    if(pos == string::npos) return "";
+    pos++;
+    return body.substr(pos, body.find('"', pos) - pos);
+}
+
+bool authenticate(const string& host, const string& port) {
+    const char* token = getenv("HMS_TOKEN");
+    if(token && *token) {
+        authToken = token;
+        return true;
+    }
+
+    const char* email = getenv("HMS_EMAIL");
+    const char* password = getenv("HMS_PASSWORD");
+    if(!email || !password) {
+        cerr << "Set HMS_TOKEN, or HMS_EMAIL and HMS_PASSWORD for an admin or receptionist" << endl;
+        return false;
+    }
+
+    string body = string("{\"email\":\"") + email + "\",\"password\":\"" + password + "\"}";
+    auto result = httpRequest(host, port, "POST", "/api/login", body);
+    authToken = jsonStringField(result.body, "token");
+    if(result.status != 200 || authToken.empty()) {
+        cerr << "Login failed for " << email << " (HTTP " << result.status << ")" << endl;
+        return false;
+    }
+    string role = jsonStringField(result.body, "role");
+    if(role != "admin" && role != "receptionist") {
+        cerr << "Logged in as " << role << "; crediting wallets needs admin or receptionist" << endl;
+        return false;
+    }
+    return true;
+}
+
+double readBalance(const string& host, const string& port, const string& userId) {
+    auto result = httpRequest(host, port, "GET", "/api/wallet/" + userId, "");
+    size_t pos = result.body.find("\"balance\":");
+    if(result.status != 200 || pos == string::npos) {
+        cerr << "Could not read wallet " << userId << " (HTTP " << result.status << ")" << endl;
+        exit(1);
+    }
+    return atof(result.body.c_str() + pos + 10);
+}
+
+bool postWallet(const string& host, const string& port, const string& userId, const string& type) {
+    string body = "{\"userId\":\"" + userId + "\",\"amount\":1.0,\"type\":\"" + type +
+                  "\",\"description\":\"stress " + type + "\"}";
+    return httpRequest(host, port, "POST", "/api/wallet", body).status == 200;
+}
+
+double percentile(vector<double>& samples, double p) {
+    if(samples.empty()) return 0.0;
+    size_t idx = min(samples.size() - 1, (size_t)(p * samples.size()));
+    nth_element(samples.begin(), samples.begin() + idx, samples.end());
+    return samples[idx];
+}
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        cerr << "usage: hms_wallet_stress <userId> [threads] [opsPerThread] [host] [port]" << endl;
+        return 2;
+    }
+
+    string userId = argv[1];
+    int threads = argc > 2 ? atoi(argv[2]) : 16;
+    int opsPerThread = argc > 3 ? atoi(argv[3]) : 500;
+    string host = argc > 4 ? argv[4] : "127.0.0.1";
+    string port = argc > 5 ? argv[5] : "8080";
+
+    if(!authenticate(host, port)) return 2;
+
+    bool ok = true;
+
+    // Phase 1: mixed credits and debits
+    double start = readBalance(host, port, userId);
+    atomic<long> credits(0), debits(0), rejected(0);
+    vector<vector<double>> latencies(threads);
+
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for(int i = 0; i < opsPerThread; i++) {
+                string type = ((i + t) % 2 == 0) ? "credit" : "debit";
+                auto begin = chrono::steady_clock::now();
+                bool success = postWallet(host, port, userId, type);
+                latencies[t].push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count());
+                if(!success) rejected++;
+                else if(type == "credit") credits++;
+                else debits++;
+            }
+        });
+    }
+    for(auto& w : workers) w.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    double expected = start + credits.load() - debits.load();
+    double actual = readBalance(host, port, userId);
+
+    vector<double> all;
+    for(auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+
+    cout << "Phase 1 (mixed): " << threads << " threads x " << opsPerThread << " ops" << endl;
+    cout << "  throughput: " << (long)(all.size() / seconds) << " ops/s" << endl;
+    cout << "  latency p50/p99: " << percentile(all, 0.50) << " / " << percentile(all, 0.99) << " ms" << endl;
+    cout << "  credits=" << credits << " debits=" << debits << " rejected=" << rejected << endl;
+    cout << "  balance expected=" << expected << " actual=" << actual << endl;
+    if(fabs(expected - actual) > 1e-6) {
+        cout << "  FAIL: lost update detected" << endl;
+        ok = false;
+    }
+
+    // Phase 2: drain the wallet concurrently
+    start = actual;
+    atomic<long> drained(0);
+    workers.clear();
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            while(postWallet(host, port, userId, "debit")) drained++;
+        });
+    }
+    for(auto& w : workers) w.join();
+
+    double remaining = readBalance(host, port, userId);
+    cout << "Phase 2 (drain): debits=" << drained << " remaining=" << remaining << endl;
+    if(remaining < 0 || fabs(start - drained.load() - remaining) > 1e-6) {
+        cout << "  FAIL: wallet overdrawn or debit lost" << endl;
+        ok = false;
+    }
+
+    // Restore the starting balance so the benchmark can be rerun
+    for(long i = 0; i < drained.load(); i++) postWallet(host, port, userId, "credit");
+
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
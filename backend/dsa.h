@@ -0,0 +1,1027 @@
+// ============================================================================
+// HOSPITAL DSA: CUSTOM CONTAINERS, SORTING AND SEARCH
+// ============================================================================
+// Everything here is plain C++17 with no Crow or Mongo dependency, so it can
+// be included on its own by hms_server and by the hms_bench microbenchmark.
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+// ============================================================================
+// ARENA NODE POOL (backs the linked containers below)
+// ============================================================================
+// Nodes are carved from blocks that grow geometrically and are recycled
+// through a free list, so a steady-state push is a pointer pop: no malloc,
+// no shared_ptr control block, no atomic refcount. Each container owns its
+// nodes outright through its pool and frees them in a loop, never by
+// recursive destructors, however long the chain.
+template<typename NodeT>
+class NodePool {
+private:
+    union Slot {
+        Slot* nextFree;
+        alignas(NodeT) unsigned char storage[sizeof(NodeT)];
+    };
+    
+    static constexpr size_t FIRST_BLOCK = 16;
+    static constexpr size_t MAX_BLOCK = 4096;
+    
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    Slot* freeList;
+    size_t nextBlockSize;
+    size_t capacity;
+    
+    void grow() {
+        blocks.emplace_back(new Slot[nextBlockSize]);
+        Slot* block = blocks.back().get();
+        for (size_t i = 0; i < nextBlockSize; i++) {
+            block[i].nextFree = freeList;
+            freeList = &block[i];
+        }
+        capacity += nextBlockSize;
+        nextBlockSize = std::min(nextBlockSize * 2, MAX_BLOCK);
+    }
+    
+public:
+    NodePool() : freeList(nullptr), nextBlockSize(FIRST_BLOCK), capacity(0) {}
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+    
+    NodePool(NodePool&& other) noexcept
+        : blocks(std::move(other.blocks)), freeList(other.freeList),
+          nextBlockSize(other.nextBlockSize), capacity(other.capacity) {
+        other.freeList = nullptr;
+        other.nextBlockSize = FIRST_BLOCK;
+        other.capacity = 0;
+    }
+    
+    NodePool& operator=(NodePool&& other) noexcept {
+        blocks = std::move(other.blocks);
+        freeList = other.freeList;
+        nextBlockSize = other.nextBlockSize;
+        capacity = other.capacity;
+        other.freeList = nullptr;
+        other.nextBlockSize = FIRST_BLOCK;
+        other.capacity = 0;
+        return *this;
+    }
+    
+    template<typename... Args>
+    NodeT* create(Args&&... args) {
+        if (!freeList) grow();
+        Slot* slot = freeList;
+        freeList = slot->nextFree;
+        try {
+            return new (slot->storage) NodeT(std::forward<Args>(args)...);
+        } catch (...) {
+            slot->nextFree = freeList;
+            freeList = slot;
+            throw;
+        }
+    }
+    
+    void destroy(NodeT* node) {
+        node->~NodeT();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->nextFree = freeList;
+        freeList = slot;
+    }
+    
+    // Slots allocated so far, live or free
+    size_t slotCapacity() const { return capacity; }
+};
+
+// Singly linked node shared by LinkedList, CustomQueue and CustomStack
+template<typename T>
+struct Node {
+    T data;
+    Node* next;
+    
+    template<typename... Args>
+    explicit Node(Args&&... args) : data(std::forward<Args>(args)...), next(nullptr) {}
+};
+
+template<typename T, bool IsConst>
+class NodeIterator {
+private:
+    using NodePtr = typename std::conditional<IsConst, const Node<T>*, Node<T>*>::type;
+    NodePtr node;
+    
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = typename std::conditional<IsConst, const T*, T*>::type;
+    using reference = typename std::conditional<IsConst, const T&, T&>::type;
+    
+    explicit NodeIterator(NodePtr n = nullptr) : node(n) {}
+    
+    reference operator*() const { return node->data; }
+    pointer operator->() const { return &node->data; }
+    NodeIterator& operator++() { node = node->next; return *this; }
+    NodeIterator operator++(int) { NodeIterator before = *this; node = node->next; return before; }
+    bool operator==(const NodeIterator& other) const { return node == other.node; }
+    bool operator!=(const NodeIterator& other) const { return node != other.node; }
+};
+
+// Frees a chain front to back; iterative, so no stack depth per node
+template<typename T>
+void destroyChain(NodePool<Node<T>>& pool, Node<T>* head) {
+    while (head) {
+        Node<T>* next = head->next;
+        pool.destroy(head);
+        head = next;
+    }
+}
+
+// ============================================================================
+// 1. CUSTOM LINKED LIST FOR PATIENT MANAGEMENT
+// ============================================================================
+template<typename T>
+class LinkedList {
+private:
+    NodePool<Node<T>> pool;
+    Node<T>* head;
+    Node<T>* tail;
+    int count;
+    
+public:
+    using iterator = NodeIterator<T, false>;
+    using const_iterator = NodeIterator<T, true>;
+    
+    LinkedList() : head(nullptr), tail(nullptr), count(0) {}
+    ~LinkedList() { destroyChain(pool, head); }
+    LinkedList(const LinkedList&) = delete;
+    LinkedList& operator=(const LinkedList&) = delete;
+    
+    LinkedList(LinkedList&& other) noexcept
+        : pool(std::move(other.pool)), head(other.head), tail(other.tail), count(other.count) {
+        other.head = other.tail = nullptr;
+        other.count = 0;
+    }
+    
+    template<typename... Args>
+    T& emplaceAtHead(Args&&... args) {
+        Node<T>* node = pool.create(std::forward<Args>(args)...);
+        node->next = head;
+        head = node;
+        if (!tail) tail = node;
+        count++;
+        return node->data;
+    }
+    
+    // O(1) through the tail pointer
+    template<typename... Args>
+    T& emplaceAtEnd(Args&&... args) {
+        Node<T>* node = pool.create(std::forward<Args>(args)...);
+        if (tail) tail->next = node;
+        else head = node;
+        tail = node;
+        count++;
+        return node->data;
+    }
+    
+    void insertAtHead(const T& data) { emplaceAtHead(data); }
+    void insertAtHead(T&& data) { emplaceAtHead(std::move(data)); }
+    void insertAtEnd(const T& data) { emplaceAtEnd(data); }
+    void insertAtEnd(T&& data) { emplaceAtEnd(std::move(data)); }
+    
+    bool deleteByValue(const T& value) {
+        Node<T>* previous = nullptr;
+        for (Node<T>* current = head; current; previous = current, current = current->next) {
+            if (current->data == value) {
+                if (previous) previous->next = current->next;
+                else head = current->next;
+                if (tail == current) tail = previous;
+                pool.destroy(current);
+                count--;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    bool search(const T& value) const {
+        for (const Node<T>* current = head; current; current = current->next) {
+            if (current->data == value) return true;
+        }
+        return false;
+    }
+    
+    void clear() {
+        destroyChain(pool, head);
+        head = tail = nullptr;
+        count = 0;
+    }
+    
+    iterator begin() { return iterator(head); }
+    iterator end() { return iterator(); }
+    const_iterator begin() const { return const_iterator(head); }
+    const_iterator end() const { return const_iterator(); }
+    
+    std::vector<T> toVector() const { return std::vector<T>(begin(), end()); }
+    
+    int size() const { return count; }
+    bool isEmpty() const { return head == nullptr; }
+};
+
+// ============================================================================
+// 2. CUSTOM QUEUE FOR APPOINTMENT PROCESSING (FIFO)
+// ============================================================================
+template<typename T>
+class CustomQueue {
+private:
+    NodePool<Node<T>> pool;
+    Node<T>* front;
+    Node<T>* rear;
+    int count;
+    
+public:
+    using iterator = NodeIterator<T, false>;
+    using const_iterator = NodeIterator<T, true>;
+    
+    CustomQueue() : front(nullptr), rear(nullptr), count(0) {}
+    ~CustomQueue() { destroyChain(pool, front); }
+    CustomQueue(const CustomQueue&) = delete;
+    CustomQueue& operator=(const CustomQueue&) = delete;
+    
+    CustomQueue(CustomQueue&& other) noexcept
+        : pool(std::move(other.pool)), front(other.front), rear(other.rear), count(other.count) {
+        other.front = other.rear = nullptr;
+        other.count = 0;
+    }
+    
+    template<typename... Args>
+    T& emplace(Args&&... args) {
+        Node<T>* node = pool.create(std::forward<Args>(args)...);
+        if (rear) rear->next = node;
+        else front = node;
+        rear = node;
+        count++;
+        return node->data;
+    }
+    
+    void enqueue(const T& data) { emplace(data); }
+    void enqueue(T&& data) { emplace(std::move(data)); }
+    
+    T dequeue() {
+        if (isEmpty()) {
+            throw std::runtime_error("Queue is empty");
+        }
+        Node<T>* node = front;
+        T data = std::move(node->data);
+        front = node->next;
+        if (!front) {
+            rear = nullptr;
+        }
+        pool.destroy(node);
+        count--;
+        return data;
+    }
+    
+    T& peek() {
+        if (isEmpty()) {
+            throw std::runtime_error("Queue is empty");
+        }
+        return front->data;
+    }
+    
+    bool isEmpty() const { return front == nullptr; }
+    int size() const { return count; }
+    
+    iterator begin() { return iterator(front); }
+    iterator end() { return iterator(); }
+    const_iterator begin() const { return const_iterator(front); }
+    const_iterator end() const { return const_iterator(); }
+    
+    std::vector<T> toVector() const { return std::vector<T>(begin(), end()); }
+};
+
+// FIFO with removal by key. Entries live in a hash map (node-based, so
+// addresses are stable) and are threaded on an intrusive doubly linked
+// list. Each entry takes the next arrival sequence number, and a Fenwick
+// tree over the sequence numbers counts the entries still queued, so both
+// removal and position lookup are O(log n). Sequence numbers are compacted
+// when they run past the tree, which keeps enqueue amortized O(log n).
+template<typename K, typename T>
+class IndexedQueue {
+private:
+    struct Entry {
+        T data;
+        int seq;
+        Entry* prev;
+        Entry* next;
+    };
+    
+    std::unordered_map<K, Entry> index;
+    Entry* front;
+    Entry* rear;
+    std::vector<int> tree;   // 1-based Fenwick tree, tree.size() - 1 sequence slots
+    int nextSeq;
+    
+    void add(int seq, int delta) {
+        for (; seq < (int)tree.size(); seq += seq & -seq) tree[seq] += delta;
+    }
+    
+    int prefix(int seq) const {
+        int sum = 0;
+        for (; seq > 0; seq -= seq & -seq) sum += tree[seq];
+        return sum;
+    }
+    
+    // Renumbers the queued entries 1..n in order and rebuilds the tree in
+    // O(n) with room for as many arrivals again
+    void compact() {
+        int count = (int)index.size();
+        int capacity = std::max(16, 2 * (count + 1));
+        tree.assign(capacity + 1, 0);
+        int seq = 0;
+        for (Entry* entry = front; entry; entry = entry->next) {
+            entry->seq = ++seq;
+            tree[seq] = 1;
+        }
+        for (int i = 1; i <= capacity; i++) {
+            int parent = i + (i & -i);
+            if (parent <= capacity) tree[parent] += tree[i];
+        }
+        nextSeq = seq + 1;
+    }
+    
+public:
+    IndexedQueue() : front(nullptr), rear(nullptr), nextSeq(1) {}
+    IndexedQueue(const IndexedQueue&) = delete;
+    IndexedQueue& operator=(const IndexedQueue&) = delete;
+    
+    // False, leaving the queue unchanged, if the key is already queued
+    bool enqueue(const K& key, T data) {
+        auto inserted = index.emplace(key, Entry{std::move(data), 0, rear, nullptr});
+        if (!inserted.second) return false;
+        Entry* entry = &inserted.first->second;
+        if (rear) rear->next = entry;
+        else front = entry;
+        rear = entry;
+        
+        if (nextSeq >= (int)tree.size()) compact();
+        else {
+            entry->seq = nextSeq++;
+            add(entry->seq, 1);
+        }
+        return true;
+    }
+    
+    bool remove(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        Entry* entry = &it->second;
+        
+        if (entry->prev) entry->prev->next = entry->next;
+        else front = entry->next;
+        if (entry->next) entry->next->prev = entry->prev;
+        else rear = entry->prev;
+        
+        add(entry->seq, -1);
+        index.erase(it);
+        return true;
+    }
+    
+    T peek() {
+        if (!front) {
+            throw std::runtime_error("Queue is empty");
+        }
+        return front->data;
+    }
+    
+    // 1-based place in line, 0 if the key is not queued
+    int positionOf(const K& key) const {
+        auto it = index.find(key);
+        return it == index.end() ? 0 : prefix(it->second.seq);
+    }
+    
+    bool get(const K& key, T& data) const {
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        data = it->second.data;
+        return true;
+    }
+    
+    bool isEmpty() const { return front == nullptr; }
+    int size() const { return (int)index.size(); }
+    
+    std::vector<T> toVector() const {
+        std::vector<T> result;
+        for (Entry* current = front; current; current = current->next) {
+            result.push_back(current->data);
+        }
+        return result;
+    }
+};
+
+// ============================================================================
+// 3. CUSTOM STACK FOR UNDO OPERATIONS (LIFO)
+// ============================================================================
+template<typename T>
+class CustomStack {
+private:
+    NodePool<Node<T>> pool;
+    Node<T>* top;
+    int count;
+    
+public:
+    using iterator = NodeIterator<T, false>;
+    using const_iterator = NodeIterator<T, true>;
+    
+    CustomStack() : top(nullptr), count(0) {}
+    ~CustomStack() { destroyChain(pool, top); }
+    CustomStack(const CustomStack&) = delete;
+    CustomStack& operator=(const CustomStack&) = delete;
+    
+    CustomStack(CustomStack&& other) noexcept
+        : pool(std::move(other.pool)), top(other.top), count(other.count) {
+        other.top = nullptr;
+        other.count = 0;
+    }
+    
+    template<typename... Args>
+    T& emplace(Args&&... args) {
+        Node<T>* node = pool.create(std::forward<Args>(args)...);
+        node->next = top;
+        top = node;
+        count++;
+        return node->data;
+    }
+    
+    void push(const T& data) { emplace(data); }
+    void push(T&& data) { emplace(std::move(data)); }
+    
+    T pop() {
+        if (isEmpty()) {
+            throw std::runtime_error("Stack is empty");
+        }
+        Node<T>* node = top;
+        T data = std::move(node->data);
+        top = node->next;
+        pool.destroy(node);
+        count--;
+        return data;
+    }
+    
+    T& peek() {
+        if (isEmpty()) {
+            throw std::runtime_error("Stack is empty");
+        }
+        return top->data;
+    }
+    
+    bool isEmpty() const { return top == nullptr; }
+    int size() const { return count; }
+    
+    // Top to bottom
+    iterator begin() { return iterator(top); }
+    iterator end() { return iterator(); }
+    const_iterator begin() const { return const_iterator(top); }
+    const_iterator end() const { return const_iterator(); }
+    
+    std::vector<T> toVector() const { return std::vector<T>(begin(), end()); }
+};
+
+// ============================================================================
+// 4. CUSTOM B+-TREE FOR MEDICAL RECORDS
+// ============================================================================
+// Ordered map with O(log n) insert and lookup and ordered range scans. Nodes
+// hold up to ORDER sorted keys in flat arrays and live in two vector arenas
+// addressed by index, so a scan walks contiguous leaf arrays along the
+// leaf chain instead of chasing one heap pointer per key.
+template<typename K, typename V, int ORDER = 32>
+class BPlusTree {
+private:
+    static_assert(ORDER >= 4, "BPlusTree ORDER must be at least 4");
+    
+    struct Leaf {
+        int count = 0;
+        int next = -1;
+        K keys[ORDER];
+        V values[ORDER];
+    };
+    
+    struct Inner {
+        int count = 0;              // keys; children = count + 1
+        K keys[ORDER];
+        int children[ORDER + 1];
+    };
+    
+    std::vector<Leaf> leaves;
+    std::vector<Inner> inners;
+    int root;
+    int height;                     // 0 while the root is a leaf
+    int total;
+    
+    // Descends towards key; separators are the first key of their right
+    // subtree, so equal keys go right
+    int findLeaf(const K& key) const {
+        int node = root;
+        for (int level = height; level > 0; level--) {
+            const Inner& inner = inners[node];
+            int slot = std::upper_bound(inner.keys, inner.keys + inner.count, key) - inner.keys;
+            node = inner.children[slot];
+        }
+        return node;
+    }
+    
+    // Inserts below node. When the node splits, returns true with the
+    // separator and the new right sibling. Element references are not held
+    // across push_back, which may move an arena.
+    bool insertInto(int node, int level, const K& key, V& value,
+                    bool& replaced, K& splitKey, int& splitNode) {
+        if (level == 0) {
+            Leaf& leaf = leaves[node];
+            int slot = std::lower_bound(leaf.keys, leaf.keys + leaf.count, key) - leaf.keys;
+            if (slot < leaf.count && !(key < leaf.keys[slot])) {
+                leaf.values[slot] = std::move(value);
+                replaced = true;
+                return false;
+            }
+            for (int i = leaf.count; i > slot; i--) {
+                leaf.keys[i] = std::move(leaf.keys[i - 1]);
+                leaf.values[i] = std::move(leaf.values[i - 1]);
+            }
+            leaf.keys[slot] = key;
+            leaf.values[slot] = std::move(value);
+            if (++leaf.count < ORDER) return false;
+            
+            splitNode = (int)leaves.size();
+            leaves.emplace_back();
+            Leaf& full = leaves[node];
+            Leaf& right = leaves[splitNode];
+            int keep = ORDER / 2;
+            for (int i = keep; i < ORDER; i++) {
+                right.keys[i - keep] = std::move(full.keys[i]);
+                right.values[i - keep] = std::move(full.values[i]);
+                full.values[i] = V();
+            }
+            right.count = ORDER - keep;
+            full.count = keep;
+            right.next = full.next;
+            full.next = splitNode;
+            splitKey = right.keys[0];
+            return true;
+        }
+        
+        int slot;
+        int child;
+        {
+            const Inner& inner = inners[node];
+            slot = std::upper_bound(inner.keys, inner.keys + inner.count, key) - inner.keys;
+            child = inner.children[slot];
+        }
+        K childKey;
+        int childSplit;
+        if (!insertInto(child, level - 1, key, value, replaced, childKey, childSplit)) return false;
+        
+        Inner& inner = inners[node];
+        for (int i = inner.count; i > slot; i--) {
+            inner.keys[i] = std::move(inner.keys[i - 1]);
+            inner.children[i + 1] = inner.children[i];
+        }
+        inner.keys[slot] = std::move(childKey);
+        inner.children[slot + 1] = childSplit;
+        if (++inner.count < ORDER) return false;
+        
+        splitNode = (int)inners.size();
+        inners.emplace_back();
+        Inner& full = inners[node];
+        Inner& right = inners[splitNode];
+        int mid = ORDER / 2;
+        splitKey = std::move(full.keys[mid]);
+        for (int i = mid + 1; i < ORDER; i++) {
+            right.keys[i - mid - 1] = std::move(full.keys[i]);
+        }
+        for (int i = mid + 1; i <= ORDER; i++) {
+            right.children[i - mid - 1] = full.children[i];
+        }
+        right.count = ORDER - mid - 1;
+        full.count = mid;
+        return true;
+    }
+    
+public:
+    BPlusTree() : root(0), height(0), total(0) {
+        leaves.emplace_back();
+    }
+    
+    // Inserts or replaces; true when the key was new
+    bool insert(const K& key, V value) {
+        bool replaced = false;
+        K splitKey;
+        int splitNode;
+        if (insertInto(root, height, key, value, replaced, splitKey, splitNode)) {
+            int newRoot = (int)inners.size();
+            inners.emplace_back();
+            Inner& top = inners[newRoot];
+            top.count = 1;
+            top.keys[0] = std::move(splitKey);
+            top.children[0] = root;
+            top.children[1] = splitNode;
+            root = newRoot;
+            height++;
+        }
+        if (!replaced) total++;
+        return !replaced;
+    }
+    
+    bool search(const K& key, V& value) const {
+        const Leaf& leaf = leaves[findLeaf(key)];
+        int slot = std::lower_bound(leaf.keys, leaf.keys + leaf.count, key) - leaf.keys;
+        if (slot == leaf.count || key < leaf.keys[slot]) return false;
+        value = leaf.values[slot];
+        return true;
+    }
+    
+    // Visits entries with from <= key < to in key order until visit
+    // returns false
+    template<typename F>
+    void scan(const K& from, const K& to, F visit) const {
+        int node = findLeaf(from);
+        const Leaf* leaf = &leaves[node];
+        int slot = std::lower_bound(leaf->keys, leaf->keys + leaf->count, from) - leaf->keys;
+        while (true) {
+            for (; slot < leaf->count; slot++) {
+                if (!(leaf->keys[slot] < to)) return;
+                if (!visit(leaf->keys[slot], leaf->values[slot])) return;
+            }
+            if (leaf->next < 0) return;
+            leaf = &leaves[leaf->next];
+            slot = 0;
+        }
+    }
+    
+    std::vector<std::pair<K, V>> inorderTraversal() const {
+        std::vector<std::pair<K, V>> result;
+        result.reserve(total);
+        int node = root;
+        for (int level = height; level > 0; level--) node = inners[node].children[0];
+        for (; node >= 0; node = leaves[node].next) {
+            const Leaf& leaf = leaves[node];
+            for (int i = 0; i < leaf.count; i++) result.emplace_back(leaf.keys[i], leaf.values[i]);
+        }
+        return result;
+    }
+    
+    int size() const { return total; }
+};
+
+// ============================================================================
+// 5. CUSTOM MAX-HEAP FOR EMERGENCY PRIORITY QUEUE
+// ============================================================================
+// Indexed binary heap: a key -> slot map is kept in step with every swap, so
+// an entry can be re-prioritised or removed by key in O(log n).
+template<typename K, typename T>
+class MaxHeap {
+private:
+    std::vector<std::pair<K, T>> heap;
+    std::unordered_map<K, int> position;
+    
+    int parent(int i) { return (i - 1) / 2; }
+    int leftChild(int i) { return 2 * i + 1; }
+    int rightChild(int i) { return 2 * i + 2; }
+    
+    void swapNodes(int i, int j) {
+        std::swap(heap[i], heap[j]);
+        position[heap[i].first] = i;
+        position[heap[j].first] = j;
+    }
+    
+    void heapifyUp(int i) {
+        while (i > 0 && heap[parent(i)].second < heap[i].second) {
+            swapNodes(i, parent(i));
+            i = parent(i);
+        }
+    }
+    
+    void heapifyDown(int i) {
+        while (true) {
+            int maxIndex = i;
+            int left = leftChild(i);
+            int right = rightChild(i);
+            
+            if (left < (int)heap.size() && heap[maxIndex].second < heap[left].second) {
+                maxIndex = left;
+            }
+            if (right < (int)heap.size() && heap[maxIndex].second < heap[right].second) {
+                maxIndex = right;
+            }
+            if (i == maxIndex) return;
+            
+            swapNodes(i, maxIndex);
+            i = maxIndex;
+        }
+    }
+    
+    // Detaches slot i by moving the last entry into it and restoring order
+    std::pair<K, T> removeAt(int i) {
+        std::pair<K, T> removed = std::move(heap[i]);
+        position.erase(removed.first);
+        
+        int last = (int)heap.size() - 1;
+        if (i != last) {
+            heap[i] = std::move(heap[last]);
+            position[heap[i].first] = i;
+        }
+        heap.pop_back();
+        
+        if (i < (int)heap.size()) {
+            K moved = heap[i].first;
+            heapifyUp(i);
+            heapifyDown(position[moved]);
+        }
+        return removed;
+    }
+    
+public:
+    // False, leaving the heap unchanged, if the key is already present
+    bool insert(const K& key, T value) {
+        if (position.count(key)) return false;
+        heap.emplace_back(key, std::move(value));
+        position[key] = (int)heap.size() - 1;
+        heapifyUp((int)heap.size() - 1);
+        return true;
+    }
+    
+    std::pair<K, T> extractMax() {
+        if (heap.empty()) {
+            throw std::runtime_error("Heap is empty");
+        }
+        return removeAt(0);
+    }
+    
+    const std::pair<K, T>& peek() {
+        if (heap.empty()) {
+            throw std::runtime_error("Heap is empty");
+        }
+        return heap[0];
+    }
+    
+    // Replaces the entry's value and sifts it whichever way the change needs
+    bool update(const K& key, T value) {
+        auto it = position.find(key);
+        if (it == position.end()) return false;
+        int i = it->second;
+        bool raised = heap[i].second < value;
+        heap[i].second = std::move(value);
+        if (raised) heapifyUp(i);
+        else heapifyDown(i);
+        return true;
+    }
+    
+    bool remove(const K& key) {
+        auto it = position.find(key);
+        if (it == position.end()) return false;
+        removeAt(it->second);
+        return true;
+    }
+    
+    bool get(const K& key, T& value) {
+        auto it = position.find(key);
+        if (it == position.end()) return false;
+        value = heap[it->second].second;
+        return true;
+    }
+    
+    bool contains(const K& key) { return position.count(key) > 0; }
+    bool isEmpty() { return heap.empty(); }
+    int size() { return heap.size(); }
+    
+    std::vector<std::pair<K, T>> toVector() { return heap; }
+};
+
+// ============================================================================
+// DATA STRUCTURES FOR HOSPITAL SYSTEM
+// ============================================================================
+
+struct PatientRecord {
+    std::string id;
+    std::string userId;
+    std::string name;
+    std::string email;
+    int age;
+    std::string gender;
+    std::string phone;
+    std::string address;
+    
+    bool operator==(const PatientRecord& other) const {
+        return id == other.id;
+    }
+    
+    bool operator!=(const PatientRecord& other) const {
+        return id != other.id;
+    }
+};
+
+struct AppointmentRecord {
+    std::string id;
+    std::string patientUserId;
+    std::string doctorUserId;
+    std::string date;
+    std::string time;
+    std::string reason;
+    std::string status;
+    std::string rejectionReason;
+    int64_t dateTimeKey = 0;
+    
+    bool operator==(const AppointmentRecord& other) const {
+        return id == other.id;
+    }
+};
+
+struct WalletUpdate {
+    std::string journalId;
+    std::string userId;
+    double oldBalance;
+    double newBalance;
+    std::string operation;
+    std::string timestamp;
+};
+
+
+// ============================================================================
+// SORTING ALGORITHMS
+// ============================================================================
+
+// QuickSort runs as an introsort over pre-extracted keys: median-of-three
+// pivots, recursion only into the smaller partition, a heapsort fallback
+// once the depth budget is spent, and insertion sort for short runs.
+const int INSERTION_SORT_THRESHOLD = 16;
+
+template<typename T>
+void insertionSort(std::vector<T>& arr, int low, int high) {
+    for (int i = low + 1; i <= high; i++) {
+        T value = std::move(arr[i]);
+        int j = i - 1;
+        while (j >= low && value < arr[j]) {
+            arr[j + 1] = std::move(arr[j]);
+            j--;
+        }
+        arr[j + 1] = std::move(value);
+    }
+}
+
+template<typename T>
+void introSortLoop(std::vector<T>& arr, int low, int high, int depthLimit) {
+    while (high - low > INSERTION_SORT_THRESHOLD) {
+        if (depthLimit == 0) {
+            std::make_heap(arr.begin() + low, arr.begin() + high + 1);
+            std::sort_heap(arr.begin() + low, arr.begin() + high + 1);
+            return;
+        }
+        depthLimit--;
+        
+        // Median of three ends up in arr[high] and serves as the pivot
+        int mid = low + (high - low) / 2;
+        if (arr[mid] < arr[low]) std::swap(arr[mid], arr[low]);
+        if (arr[high] < arr[low]) std::swap(arr[high], arr[low]);
+        if (arr[mid] < arr[high]) std::swap(arr[mid], arr[high]);
+        
+        const T& pivot = arr[high];
+        int i = low - 1;
+        for (int j = low; j < high; j++) {
+            if (arr[j] < pivot) {
+                i++;
+                std::swap(arr[i], arr[j]);
+            }
+        }
+        std::swap(arr[i + 1], arr[high]);
+        int pi = i + 1;
+        
+        if (pi - low < high - pi) {
+            introSortLoop(arr, low, pi - 1, depthLimit);
+            low = pi + 1;
+        } else {
+            introSortLoop(arr, pi + 1, high, depthLimit);
+            high = pi - 1;
+        }
+    }
+}
+
+template<typename T>
+void quickSort(std::vector<T>& arr, int low, int high) {
+    if (low >= high) return;
+    int depthLimit = 2 * (int)std::log2(high - low + 1);
+    introSortLoop(arr, low, high, depthLimit);
+    insertionSort(arr, low, high);
+}
+
+// Packs "YYYY-MM-DD" and "HH:MM" (24h, or with AM/PM) into YYYYMMDDHHMM so
+// appointments order by a single integer. Parsed once per record.
+inline int64_t makeDateTimeKey(const std::string& date, const std::string& time) {
+    int64_t ymd = 0;
+    int digits = 0;
+    for (char c : date) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            ymd = ymd * 10 + (c - '0');
+            if (++digits == 8) break;
+        }
+    }
+    if (digits != 8) ymd = 0;
+    
+    int hour = 0, minute = 0, minuteDigits = 0;
+    bool inMinutes = false, pm = false, am = false;
+    for (char c : time) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            if (!inMinutes) {
+                hour = hour * 10 + (c - '0');
+            } else if (minuteDigits < 2) {
+                minute = minute * 10 + (c - '0');
+                minuteDigits++;
+            }
+        } else if (c == ':') {
+            inMinutes = true;
+        } else if (c == 'p' || c == 'P') {
+            pm = true;
+        } else if (c == 'a' || c == 'A') {
+            am = true;
+        }
+    }
+    if (pm && hour < 12) hour += 12;
+    if (am && hour == 12) hour = 0;
+    
+    return ymd * 10000 + hour * 100 + minute;
+}
+
+// Stable merge on dateTimeKey. Only the left run is moved out, into the
+// caller's scratch buffer, and records are moved rather than copied.
+inline void merge(std::vector<AppointmentRecord>& arr, std::vector<AppointmentRecord>& scratch, int left, int mid, int right) {
+    int n1 = mid - left + 1;
+    
+    for (int i = 0; i < n1; i++)
+        scratch[i] = std::move(arr[left + i]);
+    
+    int i = 0, j = mid + 1, k = left;
+    
+    while (i < n1 && j <= right) {
+        if (arr[j].dateTimeKey < scratch[i].dateTimeKey) {
+            arr[k++] = std::move(arr[j++]);
+        } else {
+            arr[k++] = std::move(scratch[i++]);
+        }
+    }
+    
+    while (i < n1) {
+        arr[k++] = std::move(scratch[i++]);
+    }
+}
+
+inline void mergeSortRange(std::vector<AppointmentRecord>& arr, std::vector<AppointmentRecord>& scratch, int left, int right) {
+    if (left < right) {
+        int mid = left + (right - left) / 2;
+        mergeSortRange(arr, scratch, left, mid);
+        mergeSortRange(arr, scratch, mid + 1, right);
+        // Runs that are already in order (the common case for index-ordered
+        // pages) are left alone
+        if (arr[mid + 1].dateTimeKey < arr[mid].dateTimeKey) {
+            merge(arr, scratch, left, mid, right);
+        }
+    }
+}
+
+// scratch belongs to the caller and is only ever grown, so a reused buffer
+// keeps the sort allocation-free
+inline void mergeSort(std::vector<AppointmentRecord>& arr, int left, int right,
+                      std::vector<AppointmentRecord>& scratch) {
+    if (left >= right) return;
+    size_t needed = (right - left) / 2 + 1;
+    if (scratch.size() < needed) scratch.resize(needed);
+    mergeSortRange(arr, scratch, left, right);
+}
+
+inline int binarySearch(const std::vector<PatientRecord>& arr, const std::string& id) {
+    int left = 0, right = arr.size() - 1;
+    
+    while (left <= right) {
+        int mid = left + (right - left) / 2;
+        
+        if (arr[mid].id == id) {
+            return mid;
+        }
+        
+        if (arr[mid].id < id) {
+            left = mid + 1;
+        } else {
+            right = mid - 1;
+        }
+    }
+    
+    return -1;
+}
@@ -1,5 +1,6 @@
 #define CROW_MAIN
 #include "crow.h"
+#include "dsa.h"
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
 #include <mongocxx/uri.hpp>
@@ -7,7 +8,18 @@
 #include <bsoncxx/json.hpp>
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/oid.hpp>
+#include <bsoncxx/types.hpp>
+#include <bsoncxx/stdx/string_view.hpp>
+#include <mongocxx/options/find.hpp>
+#include <mongocxx/options/find_one_and_update.hpp>
+#include <mongocxx/client_session.hpp>
+#include <mongocxx/exception/operation_exception.hpp>
+#include <mongocxx/options/insert.hpp>
 #include <openssl/sha.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
@@ -17,6 +29,27 @@
 #include <ctime>
 #include <iostream>
 #include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <list>
+#include <map>
+#include <tuple>
+#include <array>
+#include <bitset>
+#include <deque>
+#include <queue>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <filesystem>
 
 using bsoncxx::builder::stream::document;
 using bsoncxx::builder::stream::finalize;
@@ -27,625 +60,3981 @@ using bsoncxx::builder::stream::close_array;
 using namespace std;
 
 // ============================================================================
-// 1. CUSTOM LINKED LIST FOR PATIENT MANAGEMENT
+// UTILITY FUNCTIONS
 // ============================================================================
-template<typename T>
-class Node {
-public:
-    T data;
-    shared_ptr<Node<T>> next;
-    
-    Node(T val) : data(val), next(nullptr) {}
-};
 
-template<typename T>
-class LinkedList {
-private:
-    shared_ptr<Node<T>> head;
-    int count;
-    
-public:
-    LinkedList() : head(nullptr), count(0) {}
-    
-    void insertAtHead(T data) {
-        auto newNode = make_shared<Node<T>>(data);
-        newNode->next = head;
-        head = newNode;
-        count++;
-    }
-    
-    void insertAtEnd(T data) {
-        auto newNode = make_shared<Node<T>>(data);
-        if (!head) {
-            head = newNode;
-        } else {
-            auto current = head;
-            while (current->next) {
-                current = current->next;
-            }
-            current->next = newNode;
-        }
-        count++;
-    }
+struct CORSMiddleware {
+    struct context {};
     
-    bool deleteByValue(T value) {
-        if (!head) return false;
-        
-        if (head->data == value) {
-            head = head->next;
-            count--;
-            return true;
-        }
-        
-        auto current = head;
-        while (current->next && current->next->data != value) {
-            current = current->next;
-        }
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+        res.set_header("Access-Control-Max-Age", "86400");
         
-        if (current->next) {
-            current->next = current->next->next;
-            count--;
-            return true;
-        }
-        return false;
-    }
-    
-    bool search(T value) {
-        auto current = head;
-        while (current) {
-            if (current->data == value) return true;
-            current = current->next;
+        if(req.method == crow::HTTPMethod::Options) {
+            res.code = 204;
+            res.end();
         }
-        return false;
     }
     
-    vector<T> toVector() {
-        vector<T> result;
-        auto current = head;
-        while (current) {
-            result.push_back(current->data);
-            current = current->next;
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        if(res.get_header_value("Access-Control-Allow-Origin").empty()) {
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
+            res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
         }
-        return result;
     }
-    
-    int size() { return count; }
-    bool isEmpty() { return head == nullptr; }
 };
 
 // ============================================================================
-// 2. CUSTOM QUEUE FOR APPOINTMENT PROCESSING (FIFO)
+// SESSION TOKENS (HMAC-SHA256 signed, verified by AuthMiddleware)
 // ============================================================================
-template<typename T>
-class QueueNode {
-public:
-    T data;
-    shared_ptr<QueueNode<T>> next;
-    
-    QueueNode(T val) : data(val), next(nullptr) {}
+// A token is "userId:role:issuedAt:signature", the signature being an
+// HMAC-SHA256 of the first three fields under a server secret. Verifying is
+// stateless; a sharded LRU of recently verified tokens skips the HMAC for
+// clients that repeat the same token on every request.
+
+struct VerifiedSession {
+    string token;
+    string userId;
+    string role;
+    time_t expiresAt;
 };
 
-template<typename T>
-class CustomQueue {
+class TokenSigner {
 private:
-    shared_ptr<QueueNode<T>> front;
-    shared_ptr<QueueNode<T>> rear;
-    int count;
+    static const int SHARD_COUNT = 8;
     
-public:
-    CustomQueue() : front(nullptr), rear(nullptr), count(0) {}
+    struct Shard {
+        mutex lock;
+        list<VerifiedSession> lru;
+        unordered_map<string, list<VerifiedSession>::iterator> index;
+    };
     
-    void enqueue(T data) {
-        auto newNode = make_shared<QueueNode<T>>(data);
-        if (isEmpty()) {
-            front = rear = newNode;
-        } else {
-            rear->next = newNode;
-            rear = newNode;
-        }
-        count++;
-    }
+    string secret;
+    time_t ttlSeconds;
+    Shard shards[SHARD_COUNT];
+    size_t shardCapacity;
     
-    T dequeue() {
-        if (isEmpty()) {
-            throw runtime_error("Queue is empty");
-        }
-        T data = front->data;
-        front = front->next;
-        if (!front) {
-            rear = nullptr;
+    string signature(const string& payload) const {
+        static const char* hexDigits = "0123456789abcdef";
+        unsigned char mac[EVP_MAX_MD_SIZE];
+        unsigned int macLength = 0;
+        HMAC(EVP_sha256(), secret.data(), (int)secret.size(),
+             reinterpret_cast<const unsigned char*>(payload.data()), payload.size(),
+             mac, &macLength);
+        
+        string hex;
+        hex.reserve(macLength * 2);
+        for(unsigned int i = 0; i < macLength; i++) {
+            hex += hexDigits[mac[i] >> 4];
+            hex += hexDigits[mac[i] & 0x0f];
         }
-        count--;
-        return data;
+        return hex;
     }
     
-    T peek() {
-        if (isEmpty()) {
-            throw runtime_error("Queue is empty");
-        }
-        return front->data;
-    }
+public:
+    TokenSigner(const string& secret, time_t ttlSeconds, size_t cacheCapacity)
+        : secret(secret), ttlSeconds(ttlSeconds),
+          shardCapacity(max<size_t>(1, cacheCapacity / SHARD_COUNT)) {}
     
-    bool isEmpty() { return front == nullptr; }
-    int size() { return count; }
+    string sign(const string& userId, const string& role) const {
+        string payload = userId + ":" + role + ":" + to_string(time(nullptr));
+        return payload + ":" + signature(payload);
+    }
     
-    vector<T> toVector() {
-        vector<T> result;
-        auto current = front;
-        while (current) {
-            result.push_back(current->data);
-            current = current->next;
+    bool verify(const string& token, VerifiedSession& session) {
+        time_t now = time(nullptr);
+        Shard& shard = shards[hash<string>{}(token) % SHARD_COUNT];
+        
+        {
+            lock_guard<mutex> guard(shard.lock);
+            auto it = shard.index.find(token);
+            if(it != shard.index.end()) {
+                if(it->second->expiresAt > now) {
+                    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                    session = *it->second;
+                    return true;
+                }
+                shard.lru.erase(it->second);
+                shard.index.erase(it);
+                return false;
+            }
         }
-        return result;
+        
+        size_t sigStart = token.rfind(':');
+        if(sigStart == string::npos) return false;
+        string payload = token.substr(0, sigStart);
+        string expected = signature(payload);
+        if(token.size() - sigStart - 1 != expected.size() ||
+           CRYPTO_memcmp(token.data() + sigStart + 1, expected.data(), expected.size()) != 0) {
+            return false;
+        }
+        
+        size_t first = payload.find(':');
+        size_t second = first == string::npos ? string::npos : payload.find(':', first + 1);
+        if(second == string::npos) return false;
+        
+        session.token = token;
+        session.userId = payload.substr(0, first);
+        session.role = payload.substr(first + 1, second - first - 1);
+        session.expiresAt = (time_t)atoll(payload.c_str() + second + 1) + ttlSeconds;
+        if(session.expiresAt <= now) return false;
+        
+        lock_guard<mutex> guard(shard.lock);
+        if(shard.index.count(token)) return true;
+        shard.lru.push_front(session);
+        shard.index[token] = shard.lru.begin();
+        if(shard.lru.size() > shardCapacity) {
+            shard.index.erase(shard.lru.back().token);
+            shard.lru.pop_back();
+        }
+        return true;
     }
 };
 
-// ============================================================================
-// 3. CUSTOM STACK FOR UNDO OPERATIONS (LIFO)
-// ============================================================================
-template<typename T>
-class StackNode {
-public:
-    T data;
-    shared_ptr<StackNode<T>> next;
+// HMS_TOKEN_SECRET keeps tokens valid across restarts; without it a random
+// per-process secret is used and every restart signs everyone out.
+string loadTokenSecret() {
+    const char* configured = getenv("HMS_TOKEN_SECRET");
+    if(configured && *configured) return configured;
     
-    StackNode(T val) : data(val), next(nullptr) {}
-};
+    unsigned char bytes[32];
+    if(RAND_bytes(bytes, sizeof(bytes)) != 1) {
+        throw runtime_error("RAND_bytes failed generating token secret");
+    }
+    CROW_LOG_WARNING << "HMS_TOKEN_SECRET not set; using a random per-process token secret";
+    return string(reinterpret_cast<char*>(bytes), sizeof(bytes));
+}
 
-template<typename T>
-class CustomStack {
-private:
-    shared_ptr<StackNode<T>> top;
-    int count;
+// Rejects /api requests without a valid token before they reach a route,
+// and hands the authenticated userId and role to the route via its context
+struct AuthMiddleware {
+    struct context {
+        bool authenticated = false;
+        string userId;
+        string role;
+    };
     
-public:
-    CustomStack() : top(nullptr), count(0) {}
-    
-    void push(T data) {
-        auto newNode = make_shared<StackNode<T>>(data);
-        newNode->next = top;
-        top = newNode;
-        count++;
-    }
+    shared_ptr<TokenSigner> signer;
     
-    T pop() {
-        if (isEmpty()) {
-            throw runtime_error("Stack is empty");
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        if(req.method == crow::HTTPMethod::Options) return;
+        if(req.url == "/api/login" || req.url == "/api/register") return;
+        
+        string token = req.get_header_value("Authorization");
+        const string bearer = "Bearer ";
+        if(token.compare(0, bearer.size(), bearer) == 0) {
+            token = token.substr(bearer.size());
         }
-        T data = top->data;
-        top = top->next;
-        count--;
-        return data;
-    }
-    
-    T peek() {
-        if (isEmpty()) {
-            throw runtime_error("Stack is empty");
+        
+        VerifiedSession session;
+        if(!signer || token.empty() || !signer->verify(token, session)) {
+            res.code = 401;
+            res.set_header("Content-Type", "application/json");
+            res.write("{\"error\":\"Missing or invalid token\"}");
+            res.end();
+            return;
         }
-        return top->data;
+        
+        ctx.authenticated = true;
+        ctx.userId = session.userId;
+        ctx.role = session.role;
     }
     
-    bool isEmpty() { return top == nullptr; }
-    int size() { return count; }
-    
-    vector<T> toVector() {
-        vector<T> result;
-        auto current = top;
-        while (current) {
-            result.push_back(current->data);
-            current = current->next;
-        }
-        return result;
-    }
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {}
 };
 
-// ============================================================================
-// 4. CUSTOM BINARY SEARCH TREE FOR MEDICAL RECORDS
-// ============================================================================
-template<typename K, typename V>
-class BSTNode {
-public:
-    K key;
-    V value;
-    shared_ptr<BSTNode<K, V>> left;
-    shared_ptr<BSTNode<K, V>> right;
+// Admin and reception staff act on every account; other users only on their own
+bool isOfficeStaff(const AuthMiddleware::context& session) {
+    return session.role == "admin" || session.role == "receptionist";
+}
+
+string getString(const crow::json::rvalue& val) {
+    return string(val.s());
+}
+
+// Unsalted SHA256, kept only to verify accounts created before PBKDF2;
+// those are rehashed on their next successful login
+string legacyPasswordHash(const string& password) {
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    SHA256_CTX sha256;
+    SHA256_Init(&sha256);
+    SHA256_Update(&sha256, password.c_str(), password.size());
+    SHA256_Final(hash, &sha256);
     
-    BSTNode(K k, V v) : key(k), value(v), left(nullptr), right(nullptr) {}
-};
+    stringstream ss;
+    for(int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+        ss << hex << setw(2) << setfill('0') << (int)hash[i];
+    }
+    return ss.str();
+}
 
-template<typename K, typename V>
-class BinarySearchTree {
-private:
-    shared_ptr<BSTNode<K, V>> root;
-    int count;
+const int PBKDF2_ITERATIONS = 100000;
+const string PBKDF2_PREFIX = "pbkdf2_sha256$";
+
+string derivePasswordKey(const string& password, const string& salt, int iterations) {
+    unsigned char key[32];
+    if(PKCS5_PBKDF2_HMAC(password.data(), (int)password.size(),
+                         reinterpret_cast<const unsigned char*>(salt.data()), (int)salt.size(),
+                         iterations, EVP_sha256(), sizeof(key), key) != 1) {
+        throw runtime_error("PBKDF2 failed");
+    }
     
-    shared_ptr<BSTNode<K, V>> insertRec(shared_ptr<BSTNode<K, V>> node, K key, V value) {
-        if (!node) {
-            count++;
-            return make_shared<BSTNode<K, V>>(key, value);
-        }
-        
-        if (key < node->key) {
-            node->left = insertRec(node->left, key, value);
-        } else if (key > node->key) {
-            node->right = insertRec(node->right, key, value);
-        } else {
-            node->value = value;
-        }
-        return node;
+    stringstream ss;
+    for(size_t i = 0; i < sizeof(key); i++) {
+        ss << hex << setw(2) << setfill('0') << (int)key[i];
+    }
+    return ss.str();
+}
+
+// Deliberately slow: call through PasswordHasher, never on a request thread.
+// Stored as "pbkdf2_sha256$<iterations>$<salt>$<key>" so the cost can be
+// raised later without invalidating existing hashes.
+string hashPassword(const string& password) {
+    static const char* hexDigits = "0123456789abcdef";
+    unsigned char saltBytes[16];
+    if(RAND_bytes(saltBytes, sizeof(saltBytes)) != 1) {
+        throw runtime_error("RAND_bytes failed generating salt");
+    }
+    string salt;
+    for(unsigned char b : saltBytes) {
+        salt += hexDigits[b >> 4];
+        salt += hexDigits[b & 0x0f];
     }
+    return PBKDF2_PREFIX + to_string(PBKDF2_ITERATIONS) + "$" + salt + "$" +
+           derivePasswordKey(password, salt, PBKDF2_ITERATIONS);
+}
+
+// needsRehash is set when the stored hash is legacy or below today's cost
+bool verifyPassword(const string& password, const string& stored, bool& needsRehash) {
+    needsRehash = false;
+    string expected, actual;
     
-    shared_ptr<BSTNode<K, V>> searchRec(shared_ptr<BSTNode<K, V>> node, K key) {
-        if (!node || node->key == key) {
-            return node;
-        }
+    if(stored.compare(0, PBKDF2_PREFIX.size(), PBKDF2_PREFIX) == 0) {
+        size_t saltStart = stored.find('$', PBKDF2_PREFIX.size());
+        size_t keyStart = saltStart == string::npos ? string::npos : stored.find('$', saltStart + 1);
+        if(keyStart == string::npos) return false;
         
-        if (key < node->key) {
-            return searchRec(node->left, key);
-        }
-        return searchRec(node->right, key);
+        int iterations = atoi(stored.c_str() + PBKDF2_PREFIX.size());
+        if(iterations <= 0) return false;
+        string salt = stored.substr(saltStart + 1, keyStart - saltStart - 1);
+        expected = stored.substr(keyStart + 1);
+        actual = derivePasswordKey(password, salt, iterations);
+        needsRehash = iterations < PBKDF2_ITERATIONS;
+    } else {
+        expected = stored;
+        actual = legacyPasswordHash(password);
+        needsRehash = true;
     }
     
-    void inorderRec(shared_ptr<BSTNode<K, V>> node, vector<pair<K, V>>& result) {
-        if (!node) return;
-        inorderRec(node->left, result);
-        result.push_back({node->key, node->value});
-        inorderRec(node->right, result);
+    return !expected.empty() && expected.size() == actual.size() &&
+           CRYPTO_memcmp(expected.data(), actual.data(), actual.size()) == 0;
+}
+
+string getStringValue(const bsoncxx::document::element& elem) {
+    if(elem && elem.type() == bsoncxx::type::k_string) {
+        return string(elem.get_string().value);
     }
-    
-public:
-    BinarySearchTree() : root(nullptr), count(0) {}
-    
-    void insert(K key, V value) {
-        root = insertRec(root, key, value);
+    return "";
+}
+
+int getIntValue(const bsoncxx::document::element& elem) {
+    if(elem && elem.type() == bsoncxx::type::k_int32) {
+        return elem.get_int32().value;
     }
-    
-    bool search(K key, V& value) {
-        auto node = searchRec(root, key);
-        if (node) {
-            value = node->value;
-            return true;
-        }
-        return false;
+    return 0;
+}
+
+double getDoubleValue(const bsoncxx::document::element& elem) {
+    if(elem && elem.type() == bsoncxx::type::k_double) {
+        return elem.get_double().value;
     }
-    
-    vector<pair<K, V>> inorderTraversal() {
-        vector<pair<K, V>> result;
-        inorderRec(root, result);
-        return result;
+    return 0.0;
+}
+
+// Builds { field: { $in: [values...] } } for batched lookups
+bsoncxx::document::value buildInFilter(const string& field, const vector<string>& values) {
+    auto builder = document{};
+    auto inArray = builder << field << open_document << "$in" << open_array;
+    for(auto& value : values) {
+        inArray << value;
     }
-    
-    int size() { return count; }
-};
+    inArray << close_array << close_document;
+    return builder.extract();
+}
+
+bool isValidObjectId(const string& id) {
+    if(id.size() != 24) return false;
+    for(char c : id) {
+        if(!isxdigit(static_cast<unsigned char>(c))) return false;
+    }
+    return true;
+}
 
 // ============================================================================
-// 5. CUSTOM MAX-HEAP FOR EMERGENCY PRIORITY QUEUE
+// PASSWORD HASHING POOL (bounded, isolated from the request threads)
 // ============================================================================
-template<typename T>
-class MaxHeap {
+// PBKDF2 costs tens of milliseconds per call. Hashes run on a fixed set of
+// workers, and the calling request thread waits for its result. At most
+// admissionLimit callers may be waiting at once; main() sets it to a quarter
+// of the Crow threads, so a login burst can never occupy most of them. Past
+// the limit, callers are refused at once and answer 503. Bulk work (import
+// hashing) shares the same workers from a background queue that is only
+// served when no login or register is waiting.
+
+class PasswordHasher {
 private:
-    vector<T> heap;
+    struct Job {
+        packaged_task<void()> task;
+        chrono::steady_clock::time_point enqueuedAt;
+        bool background = false;
+    };
     
-    int parent(int i) { return (i - 1) / 2; }
-    int leftChild(int i) { return 2 * i + 1; }
-    int rightChild(int i) { return 2 * i + 2; }
+    vector<thread> workers;
+    deque<Job> pending;
+    deque<Job> background;
+    mutex lock;
+    condition_variable available;
+    size_t admissionLimit;
+    size_t admitted;
+    bool stopping;
     
-    void heapifyUp(int i) {
-        while (i > 0 && heap[parent(i)] < heap[i]) {
-            swap(heap[i], heap[parent(i)]);
-            i = parent(i);
-        }
+    atomic<uint64_t> completed;
+    atomic<uint64_t> rejected;
+    atomic<uint64_t> hashMicros;
+    atomic<uint64_t> waitMicros;
+    atomic<uint64_t> maxHashMicros;
+    atomic<uint64_t> maxWaitMicros;
+    
+    static void raiseMax(atomic<uint64_t>& slot, uint64_t value) {
+        uint64_t current = slot.load();
+        while(value > current && !slot.compare_exchange_weak(current, value)) {}
     }
     
-    void heapifyDown(int i) {
-        int maxIndex = i;
-        int left = leftChild(i);
-        int right = rightChild(i);
-        
-        if (left < (int)heap.size() && heap[left] > heap[maxIndex]) {
-            maxIndex = left;
-        }
-        if (right < (int)heap.size() && heap[right] > heap[maxIndex]) {
-            maxIndex = right;
-        }
-        
-        if (i != maxIndex) {
-            swap(heap[i], heap[maxIndex]);
-            heapifyDown(maxIndex);
+    void workLoop() {
+        while(true) {
+            Job job;
+            {
+                unique_lock<mutex> guard(lock);
+                available.wait(guard, [this]() { return stopping || !pending.empty() || !background.empty(); });
+                auto& queue = pending.empty() ? background : pending;
+                if(queue.empty()) return;
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            
+            auto started = chrono::steady_clock::now();
+            job.task();
+            auto finished = chrono::steady_clock::now();
+            if(job.background) continue;
+            
+            uint64_t waited = chrono::duration_cast<chrono::microseconds>(started - job.enqueuedAt).count();
+            uint64_t hashed = chrono::duration_cast<chrono::microseconds>(finished - started).count();
+            waitMicros += waited;
+            hashMicros += hashed;
+            raiseMax(maxWaitMicros, waited);
+            raiseMax(maxHashMicros, hashed);
+            completed++;
         }
     }
     
 public:
-    void insert(T value) {
-        heap.push_back(value);
-        heapifyUp(heap.size() - 1);
+    PasswordHasher(size_t workerCount, size_t admissionLimit)
+        : admissionLimit(admissionLimit), admitted(0), stopping(false), completed(0), rejected(0),
+          hashMicros(0), waitMicros(0), maxHashMicros(0), maxWaitMicros(0) {
+        for(size_t i = 0; i < workerCount; i++) {
+            workers.emplace_back([this]() { workLoop(); });
+        }
     }
     
-    T extractMax() {
-        if (heap.empty()) {
-            throw runtime_error("Heap is empty");
-        }
-        
-        T maxValue = heap[0];
-        heap[0] = heap.back();
-        heap.pop_back();
-        
-        if (!heap.empty()) {
-            heapifyDown(0);
+    ~PasswordHasher() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
         }
-        
-        return maxValue;
+        available.notify_all();
+        for(auto& worker : workers) worker.join();
     }
     
-    T peek() {
-        if (heap.empty()) {
-            throw runtime_error("Heap is empty");
+    // Runs work on a pool thread and waits for it; exceptions are rethrown
+    // here. Returns false without running it when admissionLimit callers
+    // are already waiting.
+    bool run(function<void()> work) {
+        future<void> done;
+        {
+            lock_guard<mutex> guard(lock);
+            if(admitted >= admissionLimit) {
+                rejected++;
+                return false;
+            }
+            admitted++;
+            Job job;
+            job.task = packaged_task<void()>(std::move(work));
+            job.enqueuedAt = chrono::steady_clock::now();
+            done = job.task.get_future();
+            pending.push_back(std::move(job));
         }
-        return heap[0];
+        available.notify_one();
+        done.wait();
+        {
+            lock_guard<mutex> guard(lock);
+            admitted--;
+        }
+        done.get();
+        return true;
     }
     
-    bool isEmpty() { return heap.empty(); }
-    int size() { return heap.size(); }
+    // Runs work(0) .. work(count - 1) on the background queue and waits for
+    // all of them; the first exception is rethrown here. Not subject to
+    // admissionLimit, since it never holds more than the idle workers.
+    void runBackground(size_t count, const function<void(size_t)>& work) {
+        vector<future<void>> done;
+        done.reserve(count);
+        {
+            lock_guard<mutex> guard(lock);
+            for(size_t i = 0; i < count; i++) {
+                Job job;
+                job.task = packaged_task<void()>([&work, i]() { work(i); });
+                job.enqueuedAt = chrono::steady_clock::now();
+                job.background = true;
+                done.push_back(job.task.get_future());
+                background.push_back(std::move(job));
+            }
+        }
+        available.notify_all();
+        for(auto& task : done) task.wait();
+        for(auto& task : done) task.get();
+    }
     
-    vector<T> toVector() { return heap; }
+    void writeStats(crow::json::wvalue& r) {
+        size_t depth, waiting, backgroundDepth;
+        {
+            lock_guard<mutex> guard(lock);
+            depth = pending.size();
+            waiting = admitted;
+            backgroundDepth = background.size();
+        }
+        uint64_t done = completed.load();
+        r["workers"] = workers.size();
+        r["queueDepth"] = depth;
+        r["backgroundDepth"] = backgroundDepth;
+        r["waitingCallers"] = waiting;
+        r["admissionLimit"] = admissionLimit;
+        r["completed"] = done;
+        r["rejected"] = rejected.load();
+        r["avgHashMs"] = done ? hashMicros.load() / 1000.0 / done : 0.0;
+        r["maxHashMs"] = maxHashMicros.load() / 1000.0;
+        r["avgQueueWaitMs"] = done ? waitMicros.load() / 1000.0 / done : 0.0;
+        r["maxQueueWaitMs"] = maxWaitMicros.load() / 1000.0;
+    }
 };
 
+crow::response passwordHasherBusy() {
+    crow::response res(503, "{\"error\":\"Authentication service busy, retry shortly\"}");
+    res.set_header("Retry-After", "1");
+    return res;
+}
+
 // ============================================================================
-// DATA STRUCTURES FOR HOSPITAL SYSTEM
+// ACCOUNT CREATION (one transaction per account)
 // ============================================================================
+// A user, its wallet and its role profile are written together or not at
+// all. _ids are generated up front so no insert waits on another's result,
+// and the unique users.email index is the duplicate check.
 
-struct PatientRecord {
-    string id;
-    string userId;
-    string name;
-    string email;
-    int age;
-    string gender;
-    string phone;
-    string address;
+const int DUPLICATE_KEY_ERROR = 11000;
+
+// Returns false, writing nothing, when the email is already registered.
+// profileCollection may be empty for roles without a profile document.
+bool createAccount(mongocxx::client& client,
+                   const bsoncxx::document::view& userDoc,
+                   const string& userId,
+                   const string& profileCollection,
+                   const bsoncxx::document::view& profileDoc) {
+    auto db = client["hospital_management"];
+    auto walletDoc = document{}
+        << "userId" << userId
+        << "balance" << 0.0
+        << "transactions" << open_array << close_array
+        << "ledgerMigrated" << true
+        << finalize;
     
-    bool operator==(const PatientRecord& other) const {
-        return id == other.id;
+    auto session = client.start_session();
+    try {
+        session.with_transaction([&](mongocxx::client_session* txn) {
+            db["users"].insert_one(*txn, userDoc);
+            db["wallets"].insert_one(*txn, walletDoc.view());
+            if(!profileCollection.empty()) {
+                db[profileCollection].insert_one(*txn, profileDoc);
+            }
+        });
+    } catch(const mongocxx::operation_exception& e) {
+        if(e.code().value() == DUPLICATE_KEY_ERROR) return false;
+        throw;
+    }
+    return true;
+}
+
+// ============================================================================
+// KEYSET PAGINATION
+// ============================================================================
+// List endpoints page on (sort key, _id). The cursor is the hex-encoded key
+// parts of the last row served, so clients treat it as opaque.
+
+const int DEFAULT_PAGE_SIZE = 100;
+const int MAX_PAGE_SIZE = 500;
+
+int parsePageLimit(const crow::request& req) {
+    auto raw = req.url_params.get("limit");
+    if(!raw) return DEFAULT_PAGE_SIZE;
+    int limit = atoi(raw);
+    if(limit <= 0) return DEFAULT_PAGE_SIZE;
+    return min(limit, MAX_PAGE_SIZE);
+}
+
+string encodeCursor(const vector<string>& parts) {
+    static const char* hexDigits = "0123456789abcdef";
+    string joined;
+    for(size_t i = 0; i < parts.size(); i++) {
+        if(i > 0) joined += '\x1f';
+        joined += parts[i];
     }
     
-    bool operator!=(const PatientRecord& other) const {
-        return id != other.id;
+    string encoded;
+    encoded.reserve(joined.size() * 2);
+    for(unsigned char c : joined) {
+        encoded += hexDigits[c >> 4];
+        encoded += hexDigits[c & 0x0f];
     }
-};
+    return encoded;
+}
 
-struct AppointmentRecord {
-    string id;
-    string patientUserId;
-    string doctorUserId;
-    string date;
-    string time;
-    string reason;
-    string status;
-    string rejectionReason;
+bool decodeCursor(const string& cursor, size_t expectedParts, vector<string>& parts) {
+    if(cursor.size() % 2 != 0) return false;
     
-    bool operator==(const AppointmentRecord& other) const {
-        return id == other.id;
+    string joined;
+    joined.reserve(cursor.size() / 2);
+    for(size_t i = 0; i < cursor.size(); i += 2) {
+        if(!isxdigit(static_cast<unsigned char>(cursor[i])) ||
+           !isxdigit(static_cast<unsigned char>(cursor[i + 1]))) {
+            return false;
+        }
+        joined += static_cast<char>(stoi(cursor.substr(i, 2), nullptr, 16));
     }
-};
-
-struct WalletUpdate {
-    string userId;
-    double oldBalance;
-    double newBalance;
-    string operation;
-    string timestamp;
-};
+    
+    parts.clear();
+    size_t start = 0;
+    while(true) {
+        size_t sep = joined.find('\x1f', start);
+        parts.push_back(joined.substr(start, sep - start));
+        if(sep == string::npos) break;
+        start = sep + 1;
+    }
+    
+    // The last part is always the _id tie-breaker
+    return parts.size() == expectedParts && isValidObjectId(parts.back());
+}
 
+string getCurrentTimestamp() {
+    time_t now = time(0);
+    char timestamp[20];
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    return string(timestamp);
+}
 
 // ============================================================================
-// SORTING ALGORITHMS
+// WALLET LEDGER
 // ============================================================================
+// Every wallet movement is appended to the wallet_transactions collection,
+// indexed by (userId, timestamp), in the same transaction as the balance
+// change. The wallet document itself keeps only the balance and the last few
+// entries as a recent-activity summary.
 
-void quickSort(vector<crow::json::wvalue>& arr, int low, int high) {
-    if (low < high) {
-        string pivot = arr[high]["name"].dump();
-        if(!pivot.empty() && pivot.front() == '"') {
-            pivot = pivot.substr(1, pivot.length()-2);
-        }
+const int RECENT_TRANSACTIONS = 10;
+
+bool canAccessWallet(const AuthMiddleware::context& session, const string& userId) {
+    return isOfficeStaff(session) || session.userId == userId;
+}
+
+void appendLedgerEntry(mongocxx::client_session& txn, mongocxx::database& db, const string& userId,
+                       double amount, const string& type, const string& description,
+                       const string& timestamp) {
+    db["wallet_transactions"].insert_one(txn, document{}
+        << "userId" << userId
+        << "amount" << amount
+        << "type" << type
+        << "description" << description
+        << "timestamp" << timestamp
+        << finalize);
+}
+
+// { $push: { transactions: { $each: [entry], $slice: -RECENT_TRANSACTIONS } } }
+// keeps the embedded summary bounded however long the history grows
+bsoncxx::document::value recentTransactionPush(double amount, const string& type,
+                                               const string& description, const string& timestamp) {
+    return document{}
+        << "transactions" << open_document
+            << "$each" << open_array
+                << open_document
+                    << "amount" << amount
+                    << "type" << type
+                    << "description" << description
+                    << "timestamp" << timestamp
+                << close_document
+            << close_array
+            << "$slice" << -RECENT_TRANSACTIONS
+        << close_document
+        << finalize;
+}
+
+// Older seeds wrote ISO-8601 UTC timestamps ("2024-05-01T09:30:00.000Z").
+// Returns them in the server's local "YYYY-MM-DD HH:MM:SS" form so they
+// sort with everything else; other strings come back unchanged.
+string normalizeLedgerTimestamp(const string& timestamp) {
+    int year, month, day, hour, minute, second;
+    if(timestamp.size() < 19 || timestamp[10] != 'T' ||
+       sscanf(timestamp.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d", &year, &month, &day, &hour, &minute, &second) != 6) {
+        return timestamp;
+    }
+    
+    // Days since 1970-01-01 for a proleptic Gregorian date; timegm is not
+    // portable, so the UTC epoch time is computed directly
+    int y = year - (month <= 2 ? 1 : 0);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yearOfEra = y - era * 400;
+    int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    time_t utc = ((time_t)(era * 146097 + dayOfEra - 719468) * 24 + hour) * 3600 + minute * 60 + second;
+    
+    char local[20];
+    strftime(local, sizeof(local), "%Y-%m-%d %H:%M:%S", localtime(&utc));
+    return string(local);
+}
+
+// One-off move of wallets that predate the ledger, which kept their whole
+// history in the embedded transactions array. Runs at startup, before any
+// route can touch a wallet. For each wallet not yet flagged ledgerMigrated,
+// its ISO ledger timestamps are normalised and every embedded entry missing
+// from wallet_transactions is added; entries the server already appended
+// match on all their fields and are not duplicated. The embedded array is
+// then trimmed to the recent-activity summary. Migrated wallets are
+// skipped, so reruns are cheap.
+void migrateWalletLedger(mongocxx::database& db) {
+    auto wallets = db["wallets"];
+    auto ledger = db["wallet_transactions"];
+    size_t migrated = 0;
+    auto pending = document{} << "ledgerMigrated" << open_document << "$ne" << true << close_document << finalize;
+    for(auto&& wallet : wallets.find(pending.view())) {
+        string userId = getStringValue(wallet["userId"]);
         
-        int i = low - 1;
+        auto isoFilter = document{} << "userId" << userId
+            << "timestamp" << bsoncxx::types::b_regex{"^\\d{4}-\\d{2}-\\d{2}T"} << finalize;
+        for(auto&& entry : ledger.find(isoFilter.view())) {
+            ledger.update_one(
+                document{} << "_id" << entry["_id"].get_oid().value << finalize,
+                document{} << "$set" << open_document
+                    << "timestamp" << normalizeLedgerTimestamp(getStringValue(entry["timestamp"]))
+                << close_document << finalize
+            );
+        }
         
-        for (int j = low; j < high; j++) {
-            string current = arr[j]["name"].dump();
-            if(!current.empty() && current.front() == '"') {
-                current = current.substr(1, current.length()-2);
+        struct EmbeddedEntry {
+            double amount;
+            string type, description, timestamp;
+        };
+        vector<EmbeddedEntry> entries;
+        if(wallet["transactions"]) {
+            for(auto&& trans : wallet["transactions"].get_array().value) {
+                entries.push_back({getDoubleValue(trans["amount"]), getStringValue(trans["type"]),
+                                   getStringValue(trans["description"]),
+                                   normalizeLedgerTimestamp(getStringValue(trans["timestamp"]))});
             }
-            
-            if (current < pivot) {
-                i++;
-                swap(arr[i], arr[j]);
+        }
+        // Identical entries can legitimately repeat, so each distinct entry
+        // is topped up to the number of times it is embedded
+        map<tuple<string, double, string, string>, long long> occurrences;
+        for(auto& e : entries) occurrences[make_tuple(e.timestamp, e.amount, e.type, e.description)]++;
+        for(auto& item : occurrences) {
+            const auto& key = item.first;
+            auto entryDoc = document{} << "userId" << userId << "amount" << get<1>(key) << "type" << get<2>(key)
+                << "description" << get<3>(key) << "timestamp" << get<0>(key) << finalize;
+            for(long long have = ledger.count_documents(entryDoc.view()); have < item.second; have++) {
+                ledger.insert_one(entryDoc.view());
             }
         }
-        swap(arr[i + 1], arr[high]);
-        int pi = i + 1;
         
-        quickSort(arr, low, pi - 1);
-        quickSort(arr, pi + 1, high);
+        auto update = document{};
+        auto summary = update << "$set" << open_document
+            << "ledgerMigrated" << true
+            << "transactions" << open_array;
+        size_t first = entries.size() > (size_t)RECENT_TRANSACTIONS ? entries.size() - RECENT_TRANSACTIONS : 0;
+        for(size_t i = first; i < entries.size(); i++) {
+            summary << open_document
+                << "amount" << entries[i].amount
+                << "type" << entries[i].type
+                << "description" << entries[i].description
+                << "timestamp" << entries[i].timestamp
+            << close_document;
+        }
+        summary << close_array << close_document;
+        wallets.update_one(document{} << "_id" << wallet["_id"].get_oid().value << finalize, update.view());
+        
+        migrated++;
+    }
+    if(migrated > 0) {
+        CROW_LOG_INFO << "Wallet ledger migration: " << migrated << " wallets";
     }
 }
 
-void merge(vector<AppointmentRecord>& arr, int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
+// Applies a signed balance change in one find_one_and_update round trip.
+// Debits carry a balance >= amount guard, so concurrent requests can never
+// overdraw or lose each other's updates. Returns the post-image, or nothing
+// when the wallet is missing or the guard rejected the debit.
+bsoncxx::stdx::optional<bsoncxx::document::value> applyWalletDelta(mongocxx::client_session& txn,
+                                                                  mongocxx::collection& wallets,
+                                                                  const string& userId, double delta,
+                                                                  bsoncxx::document::view push) {
+    auto filter = document{};
+    filter << "userId" << userId;
+    if(delta < 0) {
+        filter << "balance" << open_document << "$gte" << -delta << close_document;
+    }
     
-    vector<AppointmentRecord> L(n1), R(n2);
+    mongocxx::options::find_one_and_update opts;
+    opts.return_document(mongocxx::options::return_document::k_after);
+    opts.projection(document{} << "balance" << 1 << finalize);
     
-    for (int i = 0; i < n1; i++)
-        L[i] = arr[left + i];
-    for (int i = 0; i < n2; i++)
-        R[i] = arr[mid + 1 + i];
+    return wallets.find_one_and_update(
+        txn,
+        filter.view(),
+        document{}
+            << "$inc" << open_document << "balance" << delta << close_document
+            << "$push" << push
+        << finalize,
+        opts
+    );
+}
+
+// ============================================================================
+// WALLET UNDO JOURNAL (per-user, striped locks, persisted)
+// ============================================================================
+// Each wallet owner has their own bounded undo stack, so an undo only ever
+// reverts that user's last operation. Users hash onto a fixed set of lock
+// stripes. Entries are written to wallet_undo_journal in the same transaction
+// as the balance change they describe, and an undo flips the entry's undone
+// flag in the transaction that reverses it, so neither a crash nor a repeated
+// undo can reverse an operation twice. Entries still open are reloaded at
+// startup.
+
+class WalletUndoJournal {
+private:
+    static const int STRIPE_COUNT = 32;
     
-    int i = 0, j = 0, k = left;
+    struct Stripe {
+        mutex lock;
+        unordered_map<string, deque<WalletUpdate>> stacks;
+    };
     
-    while (i < n1 && j < n2) {
-        string dateTimeL = L[i].date + " " + L[i].time;
-        string dateTimeR = R[j].date + " " + R[j].time;
-        
-        if (dateTimeL <= dateTimeR) {
-            arr[k] = L[i];
-            i++;
-        } else {
-            arr[k] = R[j];
-            j++;
-        }
-        k++;
-    }
+    Stripe stripes[STRIPE_COUNT];
+    size_t maxDepth;
     
-    while (i < n1) {
-        arr[k] = L[i];
-        i++;
-        k++;
+    Stripe& stripeFor(const string& userId) {
+        return stripes[hash<string>{}(userId) % STRIPE_COUNT];
     }
     
-    while (j < n2) {
-        arr[k] = R[j];
-        j++;
-        k++;
+public:
+    explicit WalletUndoJournal(size_t depth) : maxDepth(depth) {}
+    
+    void load(mongocxx::database& db) {
+        mongocxx::options::find opts;
+        opts.sort(document{} << "_id" << 1 << finalize);
+        auto openEntries = document{} << "undone" << open_document << "$ne" << true << close_document << finalize;
+        for(auto&& doc : db["wallet_undo_journal"].find(openEntries.view(), opts)) {
+            WalletUpdate update;
+            update.journalId = doc["_id"].get_oid().value.to_string();
+            update.userId = getStringValue(doc["userId"]);
+            update.oldBalance = getDoubleValue(doc["oldBalance"]);
+            update.newBalance = getDoubleValue(doc["newBalance"]);
+            update.operation = getStringValue(doc["operation"]);
+            update.timestamp = getStringValue(doc["timestamp"]);
+            
+            Stripe& stripe = stripeFor(update.userId);
+            lock_guard<mutex> guard(stripe.lock);
+            auto& stack = stripe.stacks[update.userId];
+            stack.push_back(std::move(update));
+            if(stack.size() > maxDepth) stack.pop_front();
+        }
     }
-}
+    
+    // Writes the entry inside the caller's transaction and sets its journalId
+    void persist(mongocxx::client_session& txn, mongocxx::database& db, WalletUpdate& update) {
+        bsoncxx::oid journalOid;
+        db["wallet_undo_journal"].insert_one(txn, document{}
+            << "_id" << journalOid
+            << "userId" << update.userId
+            << "oldBalance" << update.oldBalance
+            << "newBalance" << update.newBalance
+            << "operation" << update.operation
+            << "timestamp" << update.timestamp
+            << "undone" << false
+            << finalize);
+        update.journalId = journalOid.to_string();
+    }
+    
+    // Pushes a committed entry; the user's oldest entry is dropped (in memory
+    // and in Mongo) once the stack exceeds maxDepth
+    size_t push(mongocxx::database& db, WalletUpdate update) {
+        auto journal = db["wallet_undo_journal"];
+        string evictedId;
+        size_t depth;
+        {
+            Stripe& stripe = stripeFor(update.userId);
+            lock_guard<mutex> guard(stripe.lock);
+            auto& stack = stripe.stacks[update.userId];
+            stack.push_back(std::move(update));
+            if(stack.size() > maxDepth) {
+                evictedId = stack.front().journalId;
+                stack.pop_front();
+            }
+            depth = stack.size();
+        }
+        
+        if(!evictedId.empty()) {
+            journal.delete_one(document{} << "_id" << bsoncxx::oid(evictedId) << finalize);
+        }
+        return depth;
+    }
+    
+    bool pop(const string& userId, WalletUpdate& out) {
+        Stripe& stripe = stripeFor(userId);
+        lock_guard<mutex> guard(stripe.lock);
+        auto it = stripe.stacks.find(userId);
+        if(it == stripe.stacks.end() || it->second.empty()) return false;
+        out = std::move(it->second.back());
+        it->second.pop_back();
+        return true;
+    }
+    
+    // Puts back an entry whose undo could not be applied
+    void restore(const WalletUpdate& update) {
+        Stripe& stripe = stripeFor(update.userId);
+        lock_guard<mutex> guard(stripe.lock);
+        stripe.stacks[update.userId].push_back(update);
+    }
+    
+    // Marks the entry undone inside the caller's transaction. Fails if it
+    // already was, so the same operation is never reversed twice.
+    bool consume(mongocxx::client_session& txn, mongocxx::database& db,
+                 const WalletUpdate& update, const string& timestamp) {
+        auto consumed = db["wallet_undo_journal"].find_one_and_update(txn,
+            document{}
+                << "_id" << bsoncxx::oid(update.journalId)
+                << "undone" << open_document << "$ne" << true << close_document
+            << finalize,
+            document{} << "$set" << open_document
+                << "undone" << true
+                << "undoneAt" << timestamp
+            << close_document << finalize
+        );
+        return (bool)consumed;
+    }
+    
+    // Drops a consumed entry from the persisted journal once its undo landed;
+    // if this is lost the undone flag keeps it out of the next load
+    void commit(mongocxx::database& db, const WalletUpdate& update) {
+        db["wallet_undo_journal"].delete_one(document{} << "_id" << bsoncxx::oid(update.journalId) << finalize);
+    }
+    
+    size_t depth(const string& userId) {
+        Stripe& stripe = stripeFor(userId);
+        lock_guard<mutex> guard(stripe.lock);
+        auto it = stripe.stacks.find(userId);
+        return it == stripe.stacks.end() ? 0 : it->second.size();
+    }
+    
+    // Newest-first page of a user's entries, starting after afterId if given
+    vector<WalletUpdate> page(const string& userId, const string& afterId, int limit, bool& hasMore) {
+        vector<WalletUpdate> result;
+        hasMore = false;
+        
+        Stripe& stripe = stripeFor(userId);
+        lock_guard<mutex> guard(stripe.lock);
+        auto it = stripe.stacks.find(userId);
+        if(it == stripe.stacks.end()) return result;
+        
+        auto& stack = it->second;
+        auto entry = stack.rbegin();
+        if(!afterId.empty()) {
+            while(entry != stack.rend() && entry->journalId != afterId) ++entry;
+            if(entry != stack.rend()) ++entry;
+        }
+        for(; entry != stack.rend(); ++entry) {
+            if((int)result.size() == limit) {
+                hasMore = true;
+                break;
+            }
+            result.push_back(*entry);
+        }
+        return result;
+    }
+};
+
+// ============================================================================
+// STREAMING JSON WRITER
+// ============================================================================
+// Writes JSON straight from bsoncxx views into a per-thread buffer, skipping
+// the std::string -> crow::json::wvalue -> dump() copies on list routes.
+// Crow can stream a body in chunks only from a file on disk (the report
+// export spools to one). List bodies are capped by the keyset page size, so
+// they are built in memory instead of paying a disk round trip per request.
+
+class JsonWriter {
+private:
+    string& out;
+    bool needsComma;
+    
+    void separate() {
+        if(needsComma) out += ',';
+    }
+    
+    void writeEscaped(bsoncxx::stdx::string_view text) {
+        static const char* hexDigits = "0123456789abcdef";
+        out += '"';
+        for(char ch : text) {
+            unsigned char c = static_cast<unsigned char>(ch);
+            switch(c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                default:
+                    if(c < 0x20) {
+                        out += "\\u00";
+                        out += hexDigits[c >> 4];
+                        out += hexDigits[c & 0x0f];
+                    } else {
+                        out += ch;
+                    }
+            }
+        }
+        out += '"';
+    }
+    
+public:
+    explicit JsonWriter(string& buffer) : out(buffer), needsComma(false) {}
+    
+    JsonWriter& beginObject() { separate(); out += '{'; needsComma = false; return *this; }
+    JsonWriter& endObject() { out += '}'; needsComma = true; return *this; }
+    JsonWriter& beginArray() { separate(); out += '['; needsComma = false; return *this; }
+    JsonWriter& endArray() { out += ']'; needsComma = true; return *this; }
+    
+    JsonWriter& key(bsoncxx::stdx::string_view name) {
+        separate();
+        writeEscaped(name);
+        out += ':';
+        needsComma = false;
+        return *this;
+    }
+    
+    JsonWriter& value(bsoncxx::stdx::string_view text) { separate(); writeEscaped(text); needsComma = true; return *this; }
+    JsonWriter& value(const string& text) { return value(bsoncxx::stdx::string_view(text)); }
+    JsonWriter& value(const char* text) { return value(bsoncxx::stdx::string_view(text)); }
+    JsonWriter& value(bool flag) { separate(); out += flag ? "true" : "false"; needsComma = true; return *this; }
+    JsonWriter& value(int number) { return value(static_cast<long long>(number)); }
+    JsonWriter& value(long long number) { separate(); out += to_string(number); needsComma = true; return *this; }
+    
+    JsonWriter& value(double number) {
+        separate();
+        if(std::isfinite(number)) {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%.15g", number);
+            out += buf;
+        } else {
+            out += "null";
+        }
+        needsComma = true;
+        return *this;
+    }
+    
+    JsonWriter& nullValue() { separate(); out += "null"; needsComma = true; return *this; }
+    
+    // Splices in a value already rendered by another JsonWriter
+    JsonWriter& raw(bsoncxx::stdx::string_view json) { separate(); out.append(json.data(), json.size()); needsComma = true; return *this; }
+    
+    template<typename V>
+    JsonWriter& field(bsoncxx::stdx::string_view name, const V& v) {
+        key(name);
+        return value(v);
+    }
+    
+    // Typed BSON accessors mirror getStringValue/getIntValue/getDoubleValue:
+    // a missing or mistyped field is written as the type's empty value.
+    template<typename Element>
+    JsonWriter& bsonString(bsoncxx::stdx::string_view name, const Element& elem) {
+        key(name);
+        if(elem && elem.type() == bsoncxx::type::k_string) {
+            return value(elem.get_string().value);
+        }
+        return value("");
+    }
+    
+    template<typename Element>
+    JsonWriter& bsonInt(bsoncxx::stdx::string_view name, const Element& elem) {
+        key(name);
+        if(elem && elem.type() == bsoncxx::type::k_int32) {
+            return value(elem.get_int32().value);
+        }
+        return value(0);
+    }
+    
+    template<typename Element>
+    JsonWriter& bsonDouble(bsoncxx::stdx::string_view name, const Element& elem) {
+        key(name);
+        if(elem && elem.type() == bsoncxx::type::k_double) {
+            return value(elem.get_double().value);
+        }
+        return value(0.0);
+    }
+    
+    template<typename Element>
+    JsonWriter& bsonOid(bsoncxx::stdx::string_view name, const Element& elem) {
+        key(name);
+        return value(elem.get_oid().value.to_string());
+    }
+};
 
-void mergeSort(vector<AppointmentRecord>& arr, int left, int right) {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-        mergeSort(arr, left, mid);
-        mergeSort(arr, mid + 1, right);
-        merge(arr, left, mid, right);
+// Per-thread response buffer, reused across requests so list routes do not
+// regrow a fresh string every time. Oversized buffers are released.
+string& acquireResponseBuffer() {
+    static const size_t MAX_RETAINED_BUFFER = 8 * 1024 * 1024;
+    thread_local string buffer;
+    if(buffer.capacity() > MAX_RETAINED_BUFFER) {
+        string().swap(buffer);
     }
+    buffer.clear();
+    return buffer;
 }
 
-int binarySearch(vector<PatientRecord>& arr, string id) {
-    int left = 0, right = arr.size() - 1;
+// ============================================================================
+// IDENTITY CACHE (userId -> name / role / department)
+// ============================================================================
+// Sharded LRU shared by every route that resolves user ids to display data.
+// Read-through from users/doctors/patients; write routes invalidate entries.
+
+struct UserIdentity {
+    string userId;
+    string name;
+    string role;
+    string department;
+    string specialization;
+};
+
+class IdentityCache {
+private:
+    static const int SHARD_COUNT = 16;
     
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-        
-        if (arr[mid].id == id) {
-            return mid;
+    struct Shard {
+        mutex lock;
+        list<UserIdentity> lru;
+        unordered_map<string, list<UserIdentity>::iterator> index;
+    };
+    
+    Shard shards[SHARD_COUNT];
+    size_t shardCapacity;
+    atomic<uint64_t> hits;
+    atomic<uint64_t> misses;
+    
+    Shard& shardFor(const string& userId) {
+        return shards[hash<string>{}(userId) % SHARD_COUNT];
+    }
+    
+public:
+    explicit IdentityCache(size_t capacity)
+        : shardCapacity(max<size_t>(1, capacity / SHARD_COUNT)), hits(0), misses(0) {}
+    
+    bool get(const string& userId, UserIdentity& out) {
+        Shard& shard = shardFor(userId);
+        lock_guard<mutex> guard(shard.lock);
+        auto it = shard.index.find(userId);
+        if(it == shard.index.end()) {
+            misses++;
+            return false;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        out = *it->second;
+        hits++;
+        return true;
+    }
+    
+    void put(const UserIdentity& identity) {
+        Shard& shard = shardFor(identity.userId);
+        lock_guard<mutex> guard(shard.lock);
+        auto it = shard.index.find(identity.userId);
+        if(it != shard.index.end()) {
+            *it->second = identity;
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+        }
+        shard.lru.push_front(identity);
+        shard.index[identity.userId] = shard.lru.begin();
+        if(shard.lru.size() > shardCapacity) {
+            shard.index.erase(shard.lru.back().userId);
+            shard.lru.pop_back();
+        }
+    }
+    
+    void invalidate(const string& userId) {
+        Shard& shard = shardFor(userId);
+        lock_guard<mutex> guard(shard.lock);
+        auto it = shard.index.find(userId);
+        if(it != shard.index.end()) {
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
         }
+    }
+    
+    size_t size() {
+        size_t total = 0;
+        for(auto& shard : shards) {
+            lock_guard<mutex> guard(shard.lock);
+            total += shard.lru.size();
+        }
+        return total;
+    }
+    
+    size_t capacity() const { return shardCapacity * SHARD_COUNT; }
+    uint64_t hitCount() const { return hits.load(); }
+    uint64_t missCount() const { return misses.load(); }
+};
+
+// Resolves a batch of user ids, going to Mongo only for cache misses:
+// one $in query on users, one on doctors, and one on patients for ids
+// that have no users entry. Unknown ids are left out of the result.
+unordered_map<string, UserIdentity> resolveIdentities(mongocxx::database& db,
+                                                      IdentityCache& cache,
+                                                      const vector<string>& userIds) {
+    unordered_map<string, UserIdentity> resolved;
+    vector<string> missing;
+    
+    for(auto& userId : userIds) {
+        if(userId.empty() || resolved.count(userId)) continue;
+        UserIdentity identity;
+        if(cache.get(userId, identity)) {
+            resolved[userId] = identity;
+        } else if(isValidObjectId(userId)) {
+            missing.push_back(userId);
+        }
+    }
+    
+    if(missing.empty()) return resolved;
+    
+    unordered_map<string, UserIdentity> loaded;
+    
+    {
+        auto builder = document{};
+        auto inArray = builder << "_id" << open_document << "$in" << open_array;
+        for(auto& userId : missing) {
+            inArray << bsoncxx::oid(userId);
+        }
+        inArray << close_array << close_document;
         
-        if (arr[mid].id < id) {
-            left = mid + 1;
-        } else {
-            right = mid - 1;
+        mongocxx::options::find opts;
+        opts.projection(document{} << "name" << 1 << "role" << 1 << finalize);
+        for(auto&& doc : db["users"].find(builder.view(), opts)) {
+            UserIdentity identity;
+            identity.userId = doc["_id"].get_oid().value.to_string();
+            identity.name = getStringValue(doc["name"]);
+            identity.role = getStringValue(doc["role"]);
+            loaded[identity.userId] = identity;
+        }
+    }
+    
+    {
+        mongocxx::options::find opts;
+        opts.projection(document{} << "userId" << 1 << "name" << 1
+            << "department" << 1 << "specialization" << 1 << finalize);
+        for(auto&& doc : db["doctors"].find(buildInFilter("userId", missing).view(), opts)) {
+            auto& identity = loaded[getStringValue(doc["userId"])];
+            identity.userId = getStringValue(doc["userId"]);
+            if(identity.name.empty()) identity.name = getStringValue(doc["name"]);
+            if(identity.role.empty()) identity.role = "doctor";
+            identity.department = getStringValue(doc["department"]);
+            identity.specialization = getStringValue(doc["specialization"]);
+        }
+    }
+    
+    vector<string> orphans;
+    for(auto& userId : missing) {
+        if(!loaded.count(userId)) orphans.push_back(userId);
+    }
+    if(!orphans.empty()) {
+        mongocxx::options::find opts;
+        opts.projection(document{} << "userId" << 1 << "name" << 1 << finalize);
+        for(auto&& doc : db["patients"].find(buildInFilter("userId", orphans).view(), opts)) {
+            UserIdentity identity;
+            identity.userId = getStringValue(doc["userId"]);
+            identity.name = getStringValue(doc["name"]);
+            identity.role = "patient";
+            loaded[identity.userId] = identity;
         }
     }
     
-    return -1;
+    for(auto& entry : loaded) {
+        cache.put(entry.second);
+        resolved[entry.first] = std::move(entry.second);
+    }
+    return resolved;
 }
 
 // ============================================================================
-// UTILITY FUNCTIONS
+// DOCTOR SCHEDULES (hours parsed to per-weekday slot bitsets)
 // ============================================================================
+// Schedule hours are free text ("9:00 AM - 5:00 PM", "Closed"). They are
+// parsed to minute ranges when written and expanded to one bit per
+// appointment slot, so availability is a bitwise AND over a doctor's day.
 
-struct CORSMiddleware {
-    struct context {};
+const int APPOINTMENT_SLOT_MINUTES = 30;
+const int SLOTS_PER_DAY = 24 * 60 / APPOINTMENT_SLOT_MINUTES;
+
+typedef bitset<SLOTS_PER_DAY> DaySlotMask;
+
+// "9:00 AM", "9 pm" or "17:30" -> minute of day; -1 when unparseable
+int parseClockMinutes(const string& text) {
+    size_t i = text.find_first_not_of(' ');
+    if(i == string::npos) return -1;
     
-    void before_handle(crow::request& req, crow::response& res, context& ctx) {
-        res.set_header("Access-Control-Allow-Origin", "*");
-        res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
-        res.set_header("Access-Control-Max-Age", "86400");
+    int hour = 0, hourDigits = 0;
+    while(i < text.size() && isdigit(static_cast<unsigned char>(text[i])) && hourDigits < 2) {
+        hour = hour * 10 + (text[i++] - '0');
+        hourDigits++;
+    }
+    if(hourDigits == 0) return -1;
+    
+    int minute = 0;
+    if(i < text.size() && text[i] == ':') {
+        if(i + 2 >= text.size() || !isdigit(static_cast<unsigned char>(text[i + 1])) ||
+           !isdigit(static_cast<unsigned char>(text[i + 2]))) return -1;
+        minute = (text[i + 1] - '0') * 10 + (text[i + 2] - '0');
+        i += 3;
+    }
+    
+    string suffix;
+    for(; i < text.size(); i++) {
+        if(text[i] != ' ' && text[i] != '.') suffix += static_cast<char>(tolower(static_cast<unsigned char>(text[i])));
+    }
+    if(suffix == "am" || suffix == "pm") {
+        if(hour < 1 || hour > 12) return -1;
+        hour = hour % 12 + (suffix == "pm" ? 12 : 0);
+    } else if(!suffix.empty()) {
+        return -1;
+    }
+    
+    if(minute > 59 || hour > 24 || (hour == 24 && minute != 0)) return -1;
+    return hour * 60 + minute;
+}
+
+// "<start> - <end>" or "Closed"/"" (start = end = 0). False when the text
+// is not a range or the range is empty.
+bool parseScheduleHours(const string& hours, int& startMinute, int& endMinute) {
+    string folded;
+    for(char c : hours) {
+        if(c != ' ') folded += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+    if(folded.empty() || folded == "closed") {
+        startMinute = endMinute = 0;
+        return true;
+    }
+    
+    size_t dash = hours.find('-');
+    if(dash == string::npos) return false;
+    startMinute = parseClockMinutes(hours.substr(0, dash));
+    endMinute = parseClockMinutes(hours.substr(dash + 1));
+    return startMinute >= 0 && endMinute > startMinute;
+}
+
+// Days of the week (tm_wday, 0 = Sunday) a schedule entry covers; 0 if the
+// day name is unknown
+unsigned scheduleDayBits(const string& day) {
+    static const vector<string> names = {"sunday", "monday", "tuesday", "wednesday",
+                                         "thursday", "friday", "saturday"};
+    string folded;
+    for(char c : day) folded += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    if(folded == "weekday") return 0x3E;
+    for(size_t i = 0; i < names.size(); i++) {
+        if(folded == names[i]) return 1u << i;
+    }
+    return 0;
+}
+
+// Slots lying wholly inside [startMinute, endMinute)
+DaySlotMask slotsWithin(int startMinute, int endMinute) {
+    DaySlotMask mask;
+    int first = (startMinute + APPOINTMENT_SLOT_MINUTES - 1) / APPOINTMENT_SLOT_MINUTES;
+    for(int slot = first; slot < SLOTS_PER_DAY && (slot + 1) * APPOINTMENT_SLOT_MINUTES <= endMinute; slot++) {
+        mask.set(slot);
+    }
+    return mask;
+}
+
+// ============================================================================
+// DOCTOR ROSTER (typed sort keys, sorted once per change)
+// ============================================================================
+// The doctor listing is served from an in-memory snapshot. Sort keys are
+// extracted once per record and each supported order is sorted once when
+// the roster changes; requests then seek into the sorted keys by cursor.
+
+struct DoctorEntry {
+    string id;
+    string userId;
+    string name;
+    string email;
+    string department;
+    string specialization;
+    int experience;
+    vector<pair<string, string>> schedule;
+    array<DaySlotMask, 7> workingSlots;   // by tm_wday
+};
+
+struct DoctorSortKey {
+    string primary;
+    int rank;
+    string secondary;
+    string id;
+    int index;
+    
+    bool operator<(const DoctorSortKey& other) const {
+        return tie(primary, rank, secondary, id) <
+               tie(other.primary, other.rank, other.secondary, other.id);
+    }
+};
+
+// Case-folded name with the "Dr." honorific dropped, so doctors sort by
+// their actual name
+string nameCollationKey(const string& name) {
+    string key;
+    key.reserve(name.size());
+    for (char c : name) {
+        key += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+    if (key.compare(0, 3, "dr.") == 0) {
+        key.erase(0, 3);
+    } else if (key.compare(0, 3, "dr ") == 0) {
+        key.erase(0, 2);
+    }
+    size_t start = key.find_first_not_of(' ');
+    return start == string::npos ? "" : key.substr(start);
+}
+
+const vector<string> DOCTOR_SORT_FIELDS = {"name", "department", "experience"};
+
+DoctorSortKey makeDoctorSortKey(const DoctorEntry& doctor, const string& sortBy, int index) {
+    DoctorSortKey key;
+    key.id = doctor.id;
+    key.index = index;
+    key.rank = 0;
+    if (sortBy == "department") {
+        key.primary = nameCollationKey(doctor.department);
+        key.secondary = nameCollationKey(doctor.name);
+    } else if (sortBy == "experience") {
+        key.rank = -doctor.experience;
+        key.secondary = nameCollationKey(doctor.name);
+    } else {
+        key.primary = nameCollationKey(doctor.name);
+    }
+    return key;
+}
+
+struct DoctorSnapshot {
+    vector<DoctorEntry> doctors;
+    unordered_map<string, vector<DoctorSortKey>> orders;
+    vector<pair<string, int>> byId;   // (doctor _id, index), sorted for binary search
+};
+
+const DoctorEntry* findDoctorById(const DoctorSnapshot& snapshot, const string& id) {
+    auto it = lower_bound(snapshot.byId.begin(), snapshot.byId.end(), id,
+        [](const pair<string, int>& entry, const string& key) { return entry.first < key; });
+    if (it == snapshot.byId.end() || it->first != id) return nullptr;
+    return &snapshot.doctors[it->second];
+}
+
+shared_ptr<const DoctorSnapshot> loadDoctorSnapshot(mongocxx::database& db) {
+    auto snapshot = make_shared<DoctorSnapshot>();
+    
+    for (auto&& doc : db["doctors"].find({})) {
+        DoctorEntry d;
+        d.id = doc["_id"].get_oid().value.to_string();
+        d.userId = getStringValue(doc["userId"]);
+        d.name = getStringValue(doc["name"]);
+        d.email = getStringValue(doc["email"]);
+        d.department = getStringValue(doc["department"]);
+        d.specialization = getStringValue(doc["specialization"]);
+        d.experience = getIntValue(doc["experience"]);
+        if (doc["schedule"]) {
+            for (auto&& s : doc["schedule"].get_array().value) {
+                d.schedule.emplace_back(getStringValue(s["day"]), getStringValue(s["hours"]));
+                
+                // Ranges are parsed on write; entries predating that (seed
+                // data) are parsed from their hours text here
+                int startMinute, endMinute;
+                if (s["startMinute"] && s["endMinute"]) {
+                    startMinute = getIntValue(s["startMinute"]);
+                    endMinute = getIntValue(s["endMinute"]);
+                } else if (!parseScheduleHours(d.schedule.back().second, startMinute, endMinute)) {
+                    continue;
+                }
+                DaySlotMask slots = slotsWithin(startMinute, endMinute);
+                unsigned days = scheduleDayBits(d.schedule.back().first);
+                for (int wday = 0; wday < 7; wday++) {
+                    if (days & (1u << wday)) d.workingSlots[wday] = slots;
+                }
+            }
+        }
+        snapshot->doctors.push_back(std::move(d));
+    }
+    
+    for (auto& field : DOCTOR_SORT_FIELDS) {
+        vector<DoctorSortKey> keys;
+        keys.reserve(snapshot->doctors.size());
+        for (size_t i = 0; i < snapshot->doctors.size(); i++) {
+            keys.push_back(makeDoctorSortKey(snapshot->doctors[i], field, (int)i));
+        }
+        quickSort(keys, 0, (int)keys.size() - 1);
+        snapshot->orders[field] = std::move(keys);
+    }
+    
+    snapshot->byId.reserve(snapshot->doctors.size());
+    for (size_t i = 0; i < snapshot->doctors.size(); i++) {
+        snapshot->byId.emplace_back(snapshot->doctors[i].id, (int)i);
+    }
+    quickSort(snapshot->byId, 0, (int)snapshot->byId.size() - 1);
+    
+    return snapshot;
+}
+
+class DoctorRoster {
+private:
+    mutex snapshotLock;
+    mutex rebuildLock;
+    shared_ptr<const DoctorSnapshot> snapshot;
+    atomic<bool> dirty;
+    
+public:
+    DoctorRoster() : dirty(true) {}
+    
+    void invalidate() { dirty = true; }
+    
+    shared_ptr<const DoctorSnapshot> current(mongocxx::database& db) {
+        if (dirty.load()) {
+            lock_guard<mutex> rebuild(rebuildLock);
+            if (dirty.load()) {
+                // Cleared before loading so a write racing the load marks
+                // the fresh snapshot stale again
+                dirty = false;
+                try {
+                    auto fresh = loadDoctorSnapshot(db);
+                    lock_guard<mutex> guard(snapshotLock);
+                    snapshot = fresh;
+                } catch (...) {
+                    dirty = true;
+                    throw;
+                }
+            }
+        }
+        lock_guard<mutex> guard(snapshotLock);
+        return snapshot;
+    }
+};
+
+// ============================================================================
+// PATIENT INDEX (copy-on-write snapshots, O(1) lookup by id and userId)
+// ============================================================================
+// Loaded once at startup and kept in sync by the write routes, so listing
+// and lookup never touch Mongo. Records are immutable and shared. Each shard
+// is an immutable snapshot that readers grab with atomic_load; a writer
+// copies only the shard it touches and publishes it with atomic_store.
+
+using PatientPtr = shared_ptr<const PatientRecord>;
+
+struct PatientIdShard {
+    vector<PatientPtr> ordered;   // sorted by id, for keyset pages
+    unordered_map<string, PatientPtr> byId;
+};
+
+struct PatientUserShard {
+    unordered_map<string, PatientPtr> byUserId;
+};
+
+PatientRecord patientFromBson(const bsoncxx::document::view& doc) {
+    PatientRecord pr;
+    pr.id = doc["_id"].get_oid().value.to_string();
+    pr.userId = getStringValue(doc["userId"]);
+    pr.name = getStringValue(doc["name"]);
+    pr.email = getStringValue(doc["email"]);
+    pr.age = getIntValue(doc["age"]);
+    pr.gender = getStringValue(doc["gender"]);
+    pr.phone = getStringValue(doc["phone"]);
+    pr.address = getStringValue(doc["address"]);
+    return pr;
+}
+
+class PatientIndex {
+private:
+    static const int SHARD_COUNT = 64;
+    
+    shared_ptr<const PatientIdShard> idShards[SHARD_COUNT];
+    shared_ptr<const PatientUserShard> userShards[SHARD_COUNT];
+    // Writers lock the id shard, then the userId shard; readers never lock
+    mutex idWriteLocks[SHARD_COUNT];
+    mutex userWriteLocks[SHARD_COUNT];
+    atomic<size_t> count;
+    
+    static size_t shardOf(const string& key) {
+        return hash<string>{}(key) % SHARD_COUNT;
+    }
+    
+    static bool idLess(const PatientPtr& record, const string& id) {
+        return record->id < id;
+    }
+    
+    void setUserEntry(const string& userId, PatientPtr record) {
+        size_t u = shardOf(userId);
+        lock_guard<mutex> guard(userWriteLocks[u]);
+        auto next = make_shared<PatientUserShard>(*atomic_load(&userShards[u]));
+        if(record) {
+            next->byUserId[userId] = record;
+        } else {
+            next->byUserId.erase(userId);
+        }
+        atomic_store(&userShards[u], shared_ptr<const PatientUserShard>(next));
+    }
+    
+public:
+    PatientIndex() : count(0) {
+        for(int i = 0; i < SHARD_COUNT; i++) {
+            idShards[i] = make_shared<const PatientIdShard>();
+            userShards[i] = make_shared<const PatientUserShard>();
+        }
+    }
+    
+    void load(mongocxx::database& db) {
+        vector<shared_ptr<PatientIdShard>> ids(SHARD_COUNT);
+        vector<shared_ptr<PatientUserShard>> users(SHARD_COUNT);
+        for(int i = 0; i < SHARD_COUNT; i++) {
+            ids[i] = make_shared<PatientIdShard>();
+            users[i] = make_shared<PatientUserShard>();
+        }
         
-        if(req.method == crow::HTTPMethod::Options) {
-            res.code = 204;
-            res.end();
+        size_t loaded = 0;
+        mongocxx::options::find opts;
+        opts.sort(document{} << "_id" << 1 << finalize);
+        for(auto&& doc : db["patients"].find({}, opts)) {
+            auto record = make_shared<const PatientRecord>(patientFromBson(doc));
+            auto& shard = *ids[shardOf(record->id)];
+            shard.ordered.push_back(record);
+            shard.byId[record->id] = record;
+            users[shardOf(record->userId)]->byUserId[record->userId] = record;
+            loaded++;
+        }
+        
+        for(int i = 0; i < SHARD_COUNT; i++) {
+            atomic_store(&idShards[i], shared_ptr<const PatientIdShard>(ids[i]));
+            atomic_store(&userShards[i], shared_ptr<const PatientUserShard>(users[i]));
         }
+        count = loaded;
     }
     
-    void after_handle(crow::request& req, crow::response& res, context& ctx) {
-        if(res.get_header_value("Access-Control-Allow-Origin").empty()) {
-            res.set_header("Access-Control-Allow-Origin", "*");
-            res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-            res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+    void upsert(const PatientRecord& record) {
+        auto ptr = make_shared<const PatientRecord>(record);
+        size_t s = shardOf(record.id);
+        lock_guard<mutex> guard(idWriteLocks[s]);
+        
+        auto next = make_shared<PatientIdShard>(*atomic_load(&idShards[s]));
+        auto pos = lower_bound(next->ordered.begin(), next->ordered.end(), record.id, idLess);
+        if(pos != next->ordered.end() && (*pos)->id == record.id) {
+            *pos = ptr;
+        } else {
+            next->ordered.insert(pos, ptr);
+            count++;
+        }
+        next->byId[record.id] = ptr;
+        atomic_store(&idShards[s], shared_ptr<const PatientIdShard>(next));
+        
+        setUserEntry(record.userId, ptr);
+    }
+    
+    // Upserts a whole batch, copying and republishing each touched shard once
+    // rather than once per record. Later records win for repeated ids, as
+    // with successive upserts.
+    void upsertBatch(const vector<PatientRecord>& records) {
+        vector<PatientPtr> byIdShard[SHARD_COUNT];
+        vector<PatientPtr> byUserShard[SHARD_COUNT];
+        for(auto& record : records) {
+            auto ptr = make_shared<const PatientRecord>(record);
+            byIdShard[shardOf(record.id)].push_back(ptr);
+            byUserShard[shardOf(record.userId)].push_back(ptr);
+        }
+        
+        // Held until the userId shards are published, as upsert holds its
+        // one id shard; taken in index order so batches cannot deadlock
+        vector<unique_lock<mutex>> held;
+        for(int s = 0; s < SHARD_COUNT; s++) {
+            if(!byIdShard[s].empty()) held.emplace_back(idWriteLocks[s]);
+        }
+        
+        for(int s = 0; s < SHARD_COUNT; s++) {
+            auto& batch = byIdShard[s];
+            if(batch.empty()) continue;
+            stable_sort(batch.begin(), batch.end(),
+                [](const PatientPtr& a, const PatientPtr& b) { return a->id < b->id; });
+            
+            // Merge the sorted batch into the sorted shard in one pass
+            auto current = atomic_load(&idShards[s]);
+            auto next = make_shared<PatientIdShard>();
+            next->byId = current->byId;
+            next->ordered.reserve(current->ordered.size() + batch.size());
+            auto existing = current->ordered.begin();
+            for(size_t i = 0; i < batch.size(); i++) {
+                if(i + 1 < batch.size() && batch[i + 1]->id == batch[i]->id) continue;
+                const PatientPtr& ptr = batch[i];
+                while(existing != current->ordered.end() && (*existing)->id < ptr->id) {
+                    next->ordered.push_back(*existing++);
+                }
+                if(existing != current->ordered.end() && (*existing)->id == ptr->id) {
+                    existing++;
+                } else {
+                    count++;
+                }
+                next->ordered.push_back(ptr);
+                next->byId[ptr->id] = ptr;
+            }
+            next->ordered.insert(next->ordered.end(), existing, current->ordered.end());
+            atomic_store(&idShards[s], shared_ptr<const PatientIdShard>(next));
+        }
+        
+        for(int u = 0; u < SHARD_COUNT; u++) {
+            if(byUserShard[u].empty()) continue;
+            lock_guard<mutex> guard(userWriteLocks[u]);
+            auto next = make_shared<PatientUserShard>(*atomic_load(&userShards[u]));
+            for(auto& ptr : byUserShard[u]) next->byUserId[ptr->userId] = ptr;
+            atomic_store(&userShards[u], shared_ptr<const PatientUserShard>(next));
+        }
+    }
+    
+    bool erase(const string& id) {
+        size_t s = shardOf(id);
+        lock_guard<mutex> guard(idWriteLocks[s]);
+        
+        auto current = atomic_load(&idShards[s]);
+        auto it = current->byId.find(id);
+        if(it == current->byId.end()) return false;
+        string userId = it->second->userId;
+        
+        auto next = make_shared<PatientIdShard>(*current);
+        auto pos = lower_bound(next->ordered.begin(), next->ordered.end(), id, idLess);
+        next->ordered.erase(pos);
+        next->byId.erase(id);
+        atomic_store(&idShards[s], shared_ptr<const PatientIdShard>(next));
+        count--;
+        
+        setUserEntry(userId, nullptr);
+        return true;
+    }
+    
+    PatientPtr findById(const string& id) const {
+        auto shard = atomic_load(&idShards[shardOf(id)]);
+        auto it = shard->byId.find(id);
+        return it == shard->byId.end() ? nullptr : it->second;
+    }
+    
+    PatientPtr findByUserId(const string& userId) const {
+        auto shard = atomic_load(&userShards[shardOf(userId)]);
+        auto it = shard->byUserId.find(userId);
+        return it == shard->byUserId.end() ? nullptr : it->second;
+    }
+    
+    // Patients in _id order after afterId: a k-way merge over the shard
+    // snapshots, O(limit log SHARD_COUNT) once each shard is positioned
+    vector<PatientPtr> page(const string& afterId, int limit, bool& hasMore) const {
+        shared_ptr<const PatientIdShard> snapshot[SHARD_COUNT];
+        size_t positions[SHARD_COUNT];
+        
+        auto laterFirst = [&](int a, int b) {
+            return snapshot[a]->ordered[positions[a]]->id > snapshot[b]->ordered[positions[b]]->id;
+        };
+        priority_queue<int, vector<int>, decltype(laterFirst)> heads(laterFirst);
+        
+        for(int i = 0; i < SHARD_COUNT; i++) {
+            snapshot[i] = atomic_load(&idShards[i]);
+            auto& ordered = snapshot[i]->ordered;
+            positions[i] = afterId.empty() ? 0 :
+                upper_bound(ordered.begin(), ordered.end(), afterId,
+                    [](const string& id, const PatientPtr& record) { return id < record->id; }) - ordered.begin();
+            if(positions[i] < ordered.size()) heads.push(i);
+        }
+        
+        vector<PatientPtr> result;
+        while(!heads.empty() && (int)result.size() < limit) {
+            int i = heads.top();
+            heads.pop();
+            result.push_back(snapshot[i]->ordered[positions[i]]);
+            if(++positions[i] < snapshot[i]->ordered.size()) heads.push(i);
+        }
+        hasMore = !heads.empty();
+        return result;
+    }
+    
+    size_t size() const { return count.load(); }
+};
+
+// ============================================================================
+// DOCTOR SLOT INDEX (per-doctor, per-day ordered intervals)
+// ============================================================================
+// Every pending or approved appointment occupies a fixed-length slot on its
+// doctor's day. Slots are kept in an ordered map keyed by start minute, so
+// an overlap check is one lower_bound: O(log n) in that day's bookings,
+// with no Mongo query. Rejected appointments free their slot.
+
+bool statusOccupiesSlot(const string& status) {
+    return status == "pending" || status == "approved";
+}
+
+// Splits a date/time pair into (YYYYMMDD, minute of day); false when either
+// part is missing or unparseable
+bool parseAppointmentSlot(const string& date, const string& time, int32_t& day, int& minute) {
+    if(time.find_first_of("0123456789") == string::npos) return false;
+    int64_t key = makeDateTimeKey(date, time);
+    day = (int32_t)(key / 10000);
+    minute = (int)(key % 10000 / 100) * 60 + (int)(key % 100);
+    return day != 0 && minute < 24 * 60;
+}
+
+// Appointment times are stored as zero-padded 24h "HH:MM", so Mongo's string
+// order on (date, time) is the same order as the parsed datetime key
+string formatSlotTime(int minute) {
+    char buf[6];
+    snprintf(buf, sizeof(buf), "%02d:%02d", minute / 60, minute % 60);
+    return buf;
+}
+
+// Rewrites times stored before they were normalized ("9:00", "2:30 PM")
+void normalizeAppointmentTimes(mongocxx::database& db) {
+    auto appointments = db["appointments"];
+    auto filter = document{}
+        << "time" << open_document
+            << "$not" << bsoncxx::types::b_regex{"^[0-9]{2}:[0-9]{2}$"}
+        << close_document
+        << finalize;
+    
+    int fixed = 0;
+    for(auto&& doc : appointments.find(filter.view())) {
+        int32_t day;
+        int minute;
+        if(!parseAppointmentSlot(getStringValue(doc["date"]), getStringValue(doc["time"]), day, minute)) continue;
+        appointments.update_one(
+            document{} << "_id" << doc["_id"].get_oid().value << finalize,
+            document{} << "$set" << open_document << "time" << formatSlotTime(minute) << close_document << finalize
+        );
+        fixed++;
+    }
+    if(fixed > 0) {
+        CROW_LOG_INFO << "Normalized " << fixed << " appointment times to HH:MM";
+    }
+}
+
+class DoctorSlotIndex {
+private:
+    static const int STRIPE_COUNT = 32;
+    
+    typedef map<int, string> DaySlots;   // start minute -> appointment id
+    
+    struct Stripe {
+        mutex lock;
+        unordered_map<string, unordered_map<int32_t, DaySlots>> doctors;
+    };
+    
+    Stripe stripes[STRIPE_COUNT];
+    
+    Stripe& stripeFor(const string& doctorUserId) {
+        return stripes[hash<string>{}(doctorUserId) % STRIPE_COUNT];
+    }
+    
+    // Any slot starting within one slot length either side overlaps
+    static const string* findOverlap(const DaySlots& slots, int minute) {
+        auto it = slots.lower_bound(minute - APPOINTMENT_SLOT_MINUTES + 1);
+        if(it != slots.end() && it->first < minute + APPOINTMENT_SLOT_MINUTES) return &it->second;
+        return nullptr;
+    }
+    
+public:
+    void load(mongocxx::database& db) {
+        mongocxx::options::find opts;
+        opts.projection(document{} << "doctorUserId" << 1 << "date" << 1 << "time" << 1 << finalize);
+        auto filter = document{} << "status" << open_document
+            << "$in" << open_array << "pending" << "approved" << close_array
+            << close_document << finalize;
+        
+        for(auto&& doc : db["appointments"].find(filter.view(), opts)) {
+            int32_t day;
+            int minute;
+            if(!parseAppointmentSlot(getStringValue(doc["date"]), getStringValue(doc["time"]), day, minute)) continue;
+            
+            string doctorUserId = getStringValue(doc["doctorUserId"]);
+            Stripe& stripe = stripeFor(doctorUserId);
+            stripe.doctors[doctorUserId][day].emplace(minute, doc["_id"].get_oid().value.to_string());
+        }
+    }
+    
+    // Claims the slot for appointmentId unless it overlaps an existing
+    // booking, in which case conflictId is set and nothing changes
+    bool reserve(const string& doctorUserId, int32_t day, int minute,
+                 const string& appointmentId, string& conflictId) {
+        Stripe& stripe = stripeFor(doctorUserId);
+        lock_guard<mutex> guard(stripe.lock);
+        DaySlots& slots = stripe.doctors[doctorUserId][day];
+        
+        const string* overlap = findOverlap(slots, minute);
+        if(overlap && *overlap != appointmentId) {
+            conflictId = *overlap;
+            return false;
+        }
+        slots[minute] = appointmentId;
+        return true;
+    }
+    
+    // Slots of the day touched by a booking; one not aligned to the slot
+    // grid blocks both slots it straddles
+    DaySlotMask bookedSlots(const string& doctorUserId, int32_t day) {
+        DaySlotMask booked;
+        Stripe& stripe = stripeFor(doctorUserId);
+        lock_guard<mutex> guard(stripe.lock);
+        auto doctor = stripe.doctors.find(doctorUserId);
+        if(doctor == stripe.doctors.end()) return booked;
+        auto slots = doctor->second.find(day);
+        if(slots == doctor->second.end()) return booked;
+        
+        for(auto& slot : slots->second) {
+            int first = slot.first / APPOINTMENT_SLOT_MINUTES;
+            int last = (slot.first + APPOINTMENT_SLOT_MINUTES - 1) / APPOINTMENT_SLOT_MINUTES;
+            for(int i = first; i <= last && i < SLOTS_PER_DAY; i++) booked.set(i);
+        }
+        return booked;
+    }
+    
+    void release(const string& doctorUserId, int32_t day, int minute, const string& appointmentId) {
+        Stripe& stripe = stripeFor(doctorUserId);
+        lock_guard<mutex> guard(stripe.lock);
+        auto doctor = stripe.doctors.find(doctorUserId);
+        if(doctor == stripe.doctors.end()) return;
+        auto slots = doctor->second.find(day);
+        if(slots == doctor->second.end()) return;
+        
+        auto slot = slots->second.find(minute);
+        if(slot != slots->second.end() && slot->second == appointmentId) {
+            slots->second.erase(slot);
+            if(slots->second.empty()) doctor->second.erase(slots);
+        }
+    }
+};
+
+// ============================================================================
+// DOCTOR APPOINTMENT QUEUES (per-doctor indexed FIFO, striped locks)
+// ============================================================================
+// Pending appointments wait in their doctor's queue, in booking order, until
+// the doctor approves or rejects them. Queues are striped by doctor so
+// bookings for different doctors never contend; a striped appointment id ->
+// doctor map finds a patient's place from the appointment id alone.
+// Rebuilt from the pending appointments at startup.
+
+class DoctorQueues {
+private:
+    static const int STRIPE_COUNT = 32;
+    
+    struct QueueStripe {
+        mutex lock;
+        unordered_map<string, IndexedQueue<string, AppointmentRecord>> queues;
+    };
+    
+    struct OwnerStripe {
+        mutex lock;
+        unordered_map<string, string> doctorOf;   // appointment id -> doctorUserId
+    };
+    
+    QueueStripe queueStripes[STRIPE_COUNT];
+    OwnerStripe ownerStripes[STRIPE_COUNT];
+    atomic<int> total;
+    
+    QueueStripe& queueStripeFor(const string& doctorUserId) {
+        return queueStripes[hash<string>{}(doctorUserId) % STRIPE_COUNT];
+    }
+    
+    OwnerStripe& ownerStripeFor(const string& appointmentId) {
+        return ownerStripes[hash<string>{}(appointmentId) % STRIPE_COUNT];
+    }
+    
+public:
+    struct Position {
+        string doctorUserId;
+        string patientUserId;
+        int position;
+        int length;
+    };
+    
+    DoctorQueues() : total(0) {}
+    
+    void load(mongocxx::database& db) {
+        mongocxx::options::find opts;
+        opts.sort(document{} << "_id" << 1 << finalize);
+        for(auto&& doc : db["appointments"].find(document{} << "status" << "pending" << finalize, opts)) {
+            AppointmentRecord ar;
+            ar.id = doc["_id"].get_oid().value.to_string();
+            ar.patientUserId = getStringValue(doc["patientUserId"]);
+            ar.doctorUserId = getStringValue(doc["doctorUserId"]);
+            ar.date = getStringValue(doc["date"]);
+            ar.time = getStringValue(doc["time"]);
+            ar.reason = getStringValue(doc["reason"]);
+            ar.status = "pending";
+            ar.dateTimeKey = makeDateTimeKey(ar.date, ar.time);
+            enqueue(ar);
+        }
+    }
+    
+    // Returns the appointment's 1-based place in its doctor's queue
+    int enqueue(const AppointmentRecord& ar) {
+        int position;
+        {
+            QueueStripe& stripe = queueStripeFor(ar.doctorUserId);
+            lock_guard<mutex> guard(stripe.lock);
+            auto& queue = stripe.queues[ar.doctorUserId];
+            if(queue.enqueue(ar.id, ar)) total++;
+            position = queue.positionOf(ar.id);
+        }
+        OwnerStripe& owners = ownerStripeFor(ar.id);
+        lock_guard<mutex> guard(owners.lock);
+        owners.doctorOf[ar.id] = ar.doctorUserId;
+        return position;
+    }
+    
+    bool remove(const string& appointmentId) {
+        string doctorUserId;
+        {
+            OwnerStripe& owners = ownerStripeFor(appointmentId);
+            lock_guard<mutex> guard(owners.lock);
+            auto it = owners.doctorOf.find(appointmentId);
+            if(it == owners.doctorOf.end()) return false;
+            doctorUserId = std::move(it->second);
+            owners.doctorOf.erase(it);
+        }
+        QueueStripe& stripe = queueStripeFor(doctorUserId);
+        lock_guard<mutex> guard(stripe.lock);
+        auto queue = stripe.queues.find(doctorUserId);
+        if(queue == stripe.queues.end() || !queue->second.remove(appointmentId)) return false;
+        total--;
+        if(queue->second.isEmpty()) stripe.queues.erase(queue);
+        return true;
+    }
+    
+    bool positionOf(const string& appointmentId, Position& out) {
+        {
+            OwnerStripe& owners = ownerStripeFor(appointmentId);
+            lock_guard<mutex> guard(owners.lock);
+            auto it = owners.doctorOf.find(appointmentId);
+            if(it == owners.doctorOf.end()) return false;
+            out.doctorUserId = it->second;
+        }
+        QueueStripe& stripe = queueStripeFor(out.doctorUserId);
+        lock_guard<mutex> guard(stripe.lock);
+        auto queue = stripe.queues.find(out.doctorUserId);
+        if(queue == stripe.queues.end()) return false;
+        
+        AppointmentRecord ar;
+        if(!queue->second.get(appointmentId, ar)) return false;
+        out.patientUserId = ar.patientUserId;
+        out.position = queue->second.positionOf(appointmentId);
+        out.length = queue->second.size();
+        return true;
+    }
+    
+    int size(const string& doctorUserId) {
+        QueueStripe& stripe = queueStripeFor(doctorUserId);
+        lock_guard<mutex> guard(stripe.lock);
+        auto queue = stripe.queues.find(doctorUserId);
+        return queue == stripe.queues.end() ? 0 : queue->second.size();
+    }
+    
+    int size() { return total.load(); }
+};
+
+// ============================================================================
+// MEDICAL RECORDS (B+-tree keyed by patient, timestamp, id)
+// ============================================================================
+// Visits, diagnoses and prescriptions are stored in medical_records and
+// indexed in memory for every patient, so a patient's history for a date
+// range is one ordered leaf scan with no Mongo round trip. Trees are
+// striped by patient to keep writers for different patients apart.
+
+const vector<string> MEDICAL_RECORD_TYPES = {"visit", "diagnosis", "prescription"};
+
+struct MedicalRecordKey {
+    string patientUserId;
+    string timestamp;           // "YYYY-MM-DD HH:MM:SS", orders as text
+    string id;
+    
+    bool operator<(const MedicalRecordKey& other) const {
+        return tie(patientUserId, timestamp, id) < tie(other.patientUserId, other.timestamp, other.id);
+    }
+};
+
+struct MedicalRecord {
+    string id;
+    string patientUserId;
+    string doctorUserId;
+    string appointmentId;
+    string type;
+    string timestamp;
+    string summary;
+    string details;
+    string medication;
+    string dosage;
+};
+
+using MedicalRecordPtr = shared_ptr<const MedicalRecord>;
+
+MedicalRecordPtr medicalRecordFromBson(const bsoncxx::document::view& doc) {
+    auto record = make_shared<MedicalRecord>();
+    record->id = doc["_id"].get_oid().value.to_string();
+    record->patientUserId = getStringValue(doc["patientUserId"]);
+    record->doctorUserId = getStringValue(doc["doctorUserId"]);
+    record->appointmentId = getStringValue(doc["appointmentId"]);
+    record->type = getStringValue(doc["type"]);
+    record->timestamp = getStringValue(doc["timestamp"]);
+    record->summary = getStringValue(doc["summary"]);
+    record->details = getStringValue(doc["details"]);
+    record->medication = getStringValue(doc["medication"]);
+    record->dosage = getStringValue(doc["dosage"]);
+    return record;
+}
+
+class MedicalRecordIndex {
+private:
+    static const int STRIPE_COUNT = 16;
+    
+    struct Stripe {
+        mutex lock;
+        BPlusTree<MedicalRecordKey, MedicalRecordPtr> tree;
+    };
+    
+    Stripe stripes[STRIPE_COUNT];
+    
+    Stripe& stripeFor(const string& patientUserId) {
+        return stripes[hash<string>{}(patientUserId) % STRIPE_COUNT];
+    }
+    
+public:
+    void load(mongocxx::database& db) {
+        for(auto&& doc : db["medical_records"].find({})) {
+            add(medicalRecordFromBson(doc));
+        }
+    }
+    
+    void add(const MedicalRecordPtr& record) {
+        Stripe& stripe = stripeFor(record->patientUserId);
+        lock_guard<mutex> guard(stripe.lock);
+        stripe.tree.insert({record->patientUserId, record->timestamp, record->id}, record);
+    }
+    
+    // Records with from <= timestamp < to, oldest first, resuming after
+    // (afterTimestamp, afterId) when given
+    vector<MedicalRecordPtr> range(const string& patientUserId, const string& from, const string& to,
+                                   const string& afterTimestamp, const string& afterId,
+                                   int limit, bool& hasMore) {
+        MedicalRecordKey lower{patientUserId, from, ""};
+        if(!afterTimestamp.empty()) {
+            MedicalRecordKey after{patientUserId, afterTimestamp, afterId + '\0'};
+            if(lower < after) lower = after;
+        }
+        MedicalRecordKey upper{patientUserId, to, ""};
+        
+        vector<MedicalRecordPtr> records;
+        hasMore = false;
+        Stripe& stripe = stripeFor(patientUserId);
+        lock_guard<mutex> guard(stripe.lock);
+        stripe.tree.scan(lower, upper, [&](const MedicalRecordKey&, const MedicalRecordPtr& record) {
+            if((int)records.size() == limit) {
+                hasMore = true;
+                return false;
+            }
+            records.push_back(record);
+            return true;
+        });
+        return records;
+    }
+};
+
+void writeMedicalRecord(JsonWriter& json, const MedicalRecord& record) {
+    json.beginObject()
+        .field("id", record.id)
+        .field("patientUserId", record.patientUserId)
+        .field("doctorUserId", record.doctorUserId)
+        .field("appointmentId", record.appointmentId)
+        .field("type", record.type)
+        .field("timestamp", record.timestamp)
+        .field("summary", record.summary)
+        .field("details", record.details);
+    if(record.type == "prescription") {
+        json.field("medication", record.medication)
+            .field("dosage", record.dosage);
+    }
+    json.endObject();
+}
+
+// ============================================================================
+// EMERGENCY TRIAGE (indexed max-heap, persisted in the triage collection)
+// ============================================================================
+// Waiting patients are ordered by acuity (5 = critical ... 1 = routine), then
+// by arrival. The heap lock is held only for the O(log n) heap operation;
+// Mongo writes happen outside it. Intake is written to Mongo before it
+// enters the heap, and a patient is marked called after leaving it, so a
+// restart reloads exactly the waiting set.
+
+const int TRIAGE_MIN_PRIORITY = 1;
+const int TRIAGE_MAX_PRIORITY = 5;
+
+// False unless body.priority is a whole number in the triage range
+bool parseTriagePriority(const crow::json::rvalue& body, int& priority) {
+    if(!body.has("priority") || body["priority"].t() != crow::json::type::Number) return false;
+    double raw = body["priority"].d();
+    if(raw != floor(raw) || raw < TRIAGE_MIN_PRIORITY || raw > TRIAGE_MAX_PRIORITY) return false;
+    priority = (int)raw;
+    return true;
+}
+
+struct TriageEntry {
+    string id;
+    string patientUserId;
+    string patientName;
+    string complaint;
+    int priority;
+    int64_t arrivalSeq;
+    string arrivedAt;
+    
+    // Higher priority first; earlier arrival breaks ties
+    bool operator<(const TriageEntry& other) const {
+        if(priority != other.priority) return priority < other.priority;
+        return arrivalSeq > other.arrivalSeq;
+    }
+};
+
+class TriageQueue {
+private:
+    mutex lock;
+    MaxHeap<string, TriageEntry> heap;
+    atomic<int64_t> nextSeq;
+    
+public:
+    TriageQueue() : nextSeq(1) {}
+    
+    void load(mongocxx::database& db) {
+        int64_t maxSeq = 0;
+        for(auto&& doc : db["triage"].find(document{} << "status" << "waiting" << finalize)) {
+            TriageEntry entry;
+            entry.id = doc["_id"].get_oid().value.to_string();
+            entry.patientUserId = getStringValue(doc["patientUserId"]);
+            entry.patientName = getStringValue(doc["patientName"]);
+            entry.complaint = getStringValue(doc["complaint"]);
+            entry.priority = getIntValue(doc["priority"]);
+            entry.arrivalSeq = doc["arrivalSeq"] ? doc["arrivalSeq"].get_int64().value : 0;
+            entry.arrivedAt = getStringValue(doc["arrivedAt"]);
+            maxSeq = max(maxSeq, entry.arrivalSeq);
+            
+            lock_guard<mutex> guard(lock);
+            heap.insert(entry.id, std::move(entry));
+        }
+        nextSeq = maxSeq + 1;
+    }
+    
+    int64_t takeArrivalSeq() { return nextSeq++; }
+    
+    void admit(const TriageEntry& entry) {
+        lock_guard<mutex> guard(lock);
+        heap.insert(entry.id, entry);
+    }
+    
+    // Re-prioritises a waiting patient; the updated entry and the priority
+    // it replaced are copied out
+    bool reprioritize(const string& id, int priority, TriageEntry& updated, int& previousPriority) {
+        lock_guard<mutex> guard(lock);
+        if(!heap.get(id, updated)) return false;
+        previousPriority = updated.priority;
+        updated.priority = priority;
+        heap.update(id, updated);
+        return true;
+    }
+    
+    // Puts the priority back only if it is still the one this caller set, so
+    // a rollback never overwrites a concurrent re-triage
+    bool revertPriority(const string& id, int expected, int previousPriority) {
+        lock_guard<mutex> guard(lock);
+        TriageEntry entry;
+        if(!heap.get(id, entry) || entry.priority != expected) return false;
+        entry.priority = previousPriority;
+        heap.update(id, entry);
+        return true;
+    }
+    
+    // Takes a waiting patient out of line; the entry is copied out so the
+    // caller can re-admit it
+    bool remove(const string& id, TriageEntry& removed) {
+        lock_guard<mutex> guard(lock);
+        if(!heap.get(id, removed)) return false;
+        return heap.remove(id);
+    }
+    
+    bool next(TriageEntry& entry) {
+        lock_guard<mutex> guard(lock);
+        if(heap.isEmpty()) return false;
+        entry = heap.extractMax().second;
+        return true;
+    }
+    
+    // Waiting patients in the order they would be called
+    vector<TriageEntry> waiting() {
+        vector<pair<string, TriageEntry>> entries;
+        {
+            lock_guard<mutex> guard(lock);
+            entries = heap.toVector();
+        }
+        vector<TriageEntry> ordered;
+        ordered.reserve(entries.size());
+        for(auto& e : entries) ordered.push_back(std::move(e.second));
+        sort(ordered.begin(), ordered.end(), [](const TriageEntry& a, const TriageEntry& b) { return b < a; });
+        return ordered;
+    }
+    
+    int size() {
+        lock_guard<mutex> guard(lock);
+        return heap.size();
+    }
+};
+
+void writeTriageEntry(JsonWriter& json, const TriageEntry& entry) {
+    json.beginObject()
+        .field("id", entry.id)
+        .field("patientUserId", entry.patientUserId)
+        .field("patientName", entry.patientName)
+        .field("complaint", entry.complaint)
+        .field("priority", entry.priority)
+        .field("arrivedAt", entry.arrivedAt)
+        .endObject();
+}
+
+// ============================================================================
+// RESPONSE RENDERING (shared by list, lookup and bootstrap routes)
+// ============================================================================
+
+AppointmentRecord appointmentFromBson(const bsoncxx::document::view& doc) {
+    AppointmentRecord ar;
+    ar.id = doc["_id"].get_oid().value.to_string();
+    ar.patientUserId = getStringValue(doc["patientUserId"]);
+    ar.doctorUserId = getStringValue(doc["doctorUserId"]);
+    ar.date = getStringValue(doc["date"]);
+    ar.time = getStringValue(doc["time"]);
+    ar.reason = getStringValue(doc["reason"]);
+    ar.status = getStringValue(doc["status"]);
+    ar.rejectionReason = getStringValue(doc["rejectionReason"]);
+    ar.dateTimeKey = makeDateTimeKey(ar.date, ar.time);
+    return ar;
+}
+
+// One keyset page of appointments in (date, time, _id) order. Times are
+// stored as "HH:MM", so the Mongo sort, the cursor and the datetime key all
+// agree and the merge pass only confirms the page is in order.
+vector<AppointmentRecord> findAppointmentPage(mongocxx::database& db,
+                                              const bsoncxx::document::view& filter,
+                                              int limit, bool& hasMore, string& nextCursor) {
+    mongocxx::options::find opts;
+    opts.sort(document{} << "date" << 1 << "time" << 1 << "_id" << 1 << finalize);
+    opts.limit(limit + 1);
+    
+    vector<AppointmentRecord> records;
+    hasMore = false;
+    for(auto&& doc : db["appointments"].find(filter, opts)) {
+        if((int)records.size() == limit) {
+            hasMore = true;
+            break;
+        }
+        records.push_back(appointmentFromBson(doc));
+    }
+    
+    nextCursor.clear();
+    if(hasMore) {
+        auto& last = records.back();
+        nextCursor = encodeCursor({last.date, last.time, last.id});
+    }
+    
+    if(!records.empty()) {
+        thread_local vector<AppointmentRecord> scratch;
+        mergeSort(records, 0, records.size() - 1, scratch);
+    }
+    return records;
+}
+
+// Writes the appointments array with doctor/patient names resolved through
+// the identity cache (misses are batched, never one query per row)
+void writeAppointments(JsonWriter& json, mongocxx::database& db, IdentityCache& cache,
+                       const vector<AppointmentRecord>& records) {
+    vector<string> userIds;
+    userIds.reserve(records.size() * 2);
+    for(auto& ar : records) {
+        userIds.push_back(ar.doctorUserId);
+        userIds.push_back(ar.patientUserId);
+    }
+    auto identities = resolveIdentities(db, cache, userIds);
+    
+    json.beginArray();
+    for(auto& ar : records) {
+        json.beginObject()
+            .field("id", ar.id)
+            .field("doctorUserId", ar.doctorUserId)
+            .field("patientUserId", ar.patientUserId)
+            .field("date", ar.date)
+            .field("time", ar.time)
+            .field("reason", ar.reason)
+            .field("status", ar.status)
+            .field("rejectionReason", ar.rejectionReason);
+        
+        auto doctorIt = identities.find(ar.doctorUserId);
+        if(doctorIt != identities.end()) {
+            json.field("doctorName", doctorIt->second.name)
+                .field("department", doctorIt->second.department);
+        } else {
+            json.field("doctorName", "Unknown")
+                .field("department", "Unknown");
+        }
+        
+        auto patientIt = identities.find(ar.patientUserId);
+        json.field("patientName", patientIt != identities.end() ? patientIt->second.name : string("Unknown"));
+        
+        json.endObject();
+    }
+    json.endArray();
+}
+
+void writePatientProfile(JsonWriter& json, const PatientRecord& pr) {
+    json.beginObject()
+        .field("id", pr.id)
+        .field("userId", pr.userId)
+        .field("name", pr.name)
+        .field("email", pr.email)
+        .field("age", pr.age)
+        .field("gender", pr.gender)
+        .field("phone", pr.phone)
+        .field("address", pr.address)
+        .endObject();
+}
+
+bsoncxx::stdx::optional<bsoncxx::document::value> findDoctorByUserId(mongocxx::database& db,
+                                                                     const string& userId) {
+    mongocxx::options::find opts;
+    opts.projection(document{}
+        << "userId" << 1 << "name" << 1 << "email" << 1
+        << "department" << 1 << "specialization" << 1
+        << "experience" << 1 << "schedule" << 1
+        << finalize);
+    return db["doctors"].find_one(document{} << "userId" << userId << finalize, opts);
+}
+
+void writeDoctorProfile(JsonWriter& json, const bsoncxx::document::view& doc) {
+    json.beginObject()
+        .bsonOid("id", doc["_id"])
+        .bsonString("userId", doc["userId"])
+        .bsonString("name", doc["name"])
+        .bsonString("email", doc["email"])
+        .bsonString("department", doc["department"])
+        .bsonString("specialization", doc["specialization"])
+        .bsonInt("experience", doc["experience"]);
+    
+    json.key("schedule").beginArray();
+    auto schedule = doc["schedule"];
+    if(schedule && schedule.type() == bsoncxx::type::k_array) {
+        for(auto&& item : schedule.get_array().value) {
+            if(item.type() != bsoncxx::type::k_document) continue;
+            auto day = item.get_document().value;
+            json.beginObject()
+                .bsonString("day", day["day"])
+                .bsonString("hours", day["hours"])
+                .endObject();
+        }
+    }
+    json.endArray().endObject();
+}
+
+// Balance plus the recent-activity summary; full history is paged from the
+// ledger via /api/wallet/<userId>/transactions
+bsoncxx::stdx::optional<bsoncxx::document::value> findWalletSummary(mongocxx::database& db,
+                                                                    const string& userId) {
+    mongocxx::options::find opts;
+    opts.projection(document{}
+        << "balance" << 1
+        << "transactions" << open_document << "$slice" << -RECENT_TRANSACTIONS << close_document
+        << finalize);
+    return db["wallets"].find_one(document{} << "userId" << userId << finalize, opts);
+}
+
+void writeWalletSummary(JsonWriter& json, const bsoncxx::document::view& view) {
+    json.bsonDouble("balance", view["balance"]);
+    
+    json.key("transactions").beginArray();
+    if(view["transactions"]) {
+        for(auto&& trans : view["transactions"].get_array().value) {
+            json.beginObject()
+                .bsonDouble("amount", trans["amount"])
+                .bsonString("type", trans["type"])
+                .bsonString("description", trans["description"])
+                .bsonString("timestamp", trans["timestamp"])
+                .endObject();
+        }
+    }
+    json.endArray();
+}
+
+// ============================================================================
+// BULK IMPORT (NDJSON / CSV, batched insert_many)
+// ============================================================================
+// Rows are parsed one at a time from the body and written in batches: one
+// insert_many each for users, profiles and wallets, all in one transaction.
+// Rows whose email is already taken are reported by their 1-based row number
+// and left out of the batch; the unique users.email index still has the last
+// word.
+
+typedef unordered_map<string, string> ImportRow;
+
+const int DEFAULT_IMPORT_BATCH = 1000;
+const int MAX_IMPORT_BATCH = 10000;
+const size_t MAX_REPORTED_IMPORT_ERRORS = 1000;
+
+class ImportReader {
+private:
+    const string& body;
+    size_t pos;
+    bool csv;
+    int rowNumber;
+    vector<string> header;
+    
+    // One CSV record starting at pos; quoted fields may contain commas,
+    // doubled quotes and newlines
+    bool readCsvRecord(vector<string>& fields) {
+        fields.clear();
+        if(pos >= body.size()) return false;
+        
+        string field;
+        bool quoted = false;
+        while(pos < body.size()) {
+            char c = body[pos++];
+            if(quoted) {
+                if(c == '"') {
+                    if(pos < body.size() && body[pos] == '"') {
+                        field += '"';
+                        pos++;
+                    } else {
+                        quoted = false;
+                    }
+                } else {
+                    field += c;
+                }
+            } else if(c == '"') {
+                quoted = true;
+            } else if(c == ',') {
+                fields.push_back(field);
+                field.clear();
+            } else if(c == '\n') {
+                break;
+            } else if(c != '\r') {
+                field += c;
+            }
+        }
+        fields.push_back(field);
+        return true;
+    }
+    
+    bool readLine(string& line) {
+        if(pos >= body.size()) return false;
+        size_t end = body.find('\n', pos);
+        if(end == string::npos) end = body.size();
+        line.assign(body, pos, end - pos);
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        pos = end + 1;
+        return true;
+    }
+    
+public:
+    ImportReader(const string& body, bool csv) : body(body), pos(0), csv(csv), rowNumber(0) {
+        if(csv) {
+            readCsvRecord(header);
+            for(auto& column : header) {
+                column.erase(0, column.find_first_not_of(" \t"));
+                column.erase(column.find_last_not_of(" \t") + 1);
+            }
+        }
+    }
+    
+    // Returns false at end of input. A row that cannot be parsed comes
+    // back with error set so the caller can report it and carry on.
+    bool next(ImportRow& row, int& number, string& error) {
+        row.clear();
+        error.clear();
+        
+        if(csv) {
+            vector<string> fields;
+            do {
+                if(!readCsvRecord(fields)) return false;
+            } while(fields.size() == 1 && fields[0].empty());
+            
+            number = ++rowNumber;
+            if(fields.size() != header.size()) {
+                error = "expected " + to_string(header.size()) + " columns, found " + to_string(fields.size());
+                return true;
+            }
+            for(size_t i = 0; i < header.size(); i++) {
+                row[header[i]] = fields[i];
+            }
+            return true;
+        }
+        
+        string line;
+        do {
+            if(!readLine(line)) return false;
+        } while(line.find_first_not_of(" \t") == string::npos);
+        
+        number = ++rowNumber;
+        auto parsed = crow::json::load(line);
+        if(!parsed || parsed.t() != crow::json::type::Object) {
+            error = "invalid JSON object";
+            return true;
+        }
+        for(auto& field : parsed) {
+            switch(field.t()) {
+                case crow::json::type::String:
+                    row[field.key()] = string(field.s());
+                    break;
+                case crow::json::type::Number: {
+                    double number = field.d();
+                    row[field.key()] = number == floor(number) ? to_string((long long)number) : to_string(number);
+                    break;
+                }
+                case crow::json::type::True:
+                    row[field.key()] = "true";
+                    break;
+                case crow::json::type::False:
+                    row[field.key()] = "false";
+                    break;
+                default:
+                    break;
+            }
+        }
+        return true;
+    }
+};
+
+struct PendingAccount {
+    int row;
+    bsoncxx::oid userOid;
+    bsoncxx::oid profileOid;
+    ImportRow fields;
+    string passwordHash;
+};
+
+struct ImportReport {
+    int imported = 0;
+    int failed = 0;
+    int batches = 0;
+    vector<pair<int, string>> errors;
+    
+    void fail(int row, const string& message) {
+        failed++;
+        if(errors.size() < MAX_REPORTED_IMPORT_ERRORS) errors.push_back({row, message});
+    }
+};
+
+string importField(const ImportRow& row, const string& name, const string& fallback = "") {
+    auto it = row.find(name);
+    return it == row.end() || it->second.empty() ? fallback : it->second;
+}
+
+// Checks required fields for the import kind; returns an error or ""
+string validateImportRow(const string& kind, const ImportRow& row) {
+    string email = importField(row, "email");
+    if(importField(row, "name").empty()) return "name is required";
+    if(email.empty() || email.find('@') == string::npos) return "a valid email is required";
+    
+    string passwordHash = importField(row, "passwordHash");
+    if(!passwordHash.empty()) {
+        if(passwordHash.compare(0, PBKDF2_PREFIX.size(), PBKDF2_PREFIX) != 0) return "passwordHash must be pbkdf2_sha256";
+    } else if(importField(row, "password").empty()) {
+        return "password is required";
+    }
+    
+    const char* numericField = kind == "patients" ? "age" : "experience";
+    string number = importField(row, numericField, "0");
+    if(number.size() > 3 || number.find_first_not_of("0123456789") != string::npos) {
+        return string(numericField) + " must be a whole number";
+    }
+    return "";
+}
+
+// PBKDF2 is the dominant cost of an import. Each batch is hashed on the
+// password pool's background queue, so it runs in parallel on the pool's
+// workers but never ahead of a login or register.
+void hashImportPasswords(PasswordHasher& hasher, vector<PendingAccount>& batch) {
+    hasher.runBackground(batch.size(), [&batch](size_t i) {
+        auto& account = batch[i];
+        account.passwordHash = importField(account.fields, "passwordHash");
+        if(account.passwordHash.empty()) {
+            account.passwordHash = hashPassword(importField(account.fields, "password"));
+        }
+    });
+}
+
+void flushImportBatch(mongocxx::client& client, PasswordHasher& hasher, const string& kind,
+                      vector<PendingAccount>& batch, ImportReport& report,
+                      const function<void(const vector<PendingAccount*>&)>& onImported) {
+    if(batch.empty()) return;
+    report.batches++;
+    hashImportPasswords(hasher, batch);
+    auto db = client["hospital_management"];
+    
+    // Emails already registered, or repeated earlier in the batch, fail up
+    // front: inside the transaction a single duplicate key would abort the
+    // whole batch
+    auto emailFilter = document{};
+    auto emails = emailFilter << "email" << open_document << "$in" << open_array;
+    for(auto& account : batch) emails << importField(account.fields, "email");
+    emails << close_array << close_document;
+    
+    mongocxx::options::find opts;
+    opts.projection(document{} << "email" << 1 << finalize);
+    unordered_set<string> taken;
+    for(auto&& doc : db["users"].find(emailFilter.view(), opts)) {
+        taken.insert(getStringValue(doc["email"]));
+    }
+    
+    vector<PendingAccount*> accepted;
+    for(auto& account : batch) {
+        if(!taken.insert(importField(account.fields, "email")).second) {
+            report.fail(account.row, "email already registered");
+        } else {
+            accepted.push_back(&account);
+        }
+    }
+    
+    string role = kind == "patients" ? "patient" : "doctor";
+    vector<bsoncxx::document::value> users, profiles, wallets;
+    users.reserve(accepted.size());
+    profiles.reserve(accepted.size());
+    wallets.reserve(accepted.size());
+    for(auto* account : accepted) {
+        const ImportRow& f = account->fields;
+        string userId = account->userOid.to_string();
+        users.push_back(document{}
+            << "_id" << account->userOid
+            << "email" << importField(f, "email")
+            << "password" << account->passwordHash
+            << "role" << role
+            << "name" << importField(f, "name")
+            << finalize);
+        if(kind == "patients") {
+            profiles.push_back(document{}
+                << "_id" << account->profileOid
+                << "userId" << userId
+                << "name" << importField(f, "name")
+                << "email" << importField(f, "email")
+                << "age" << atoi(importField(f, "age", "0").c_str())
+                << "gender" << importField(f, "gender", "not specified")
+                << "phone" << importField(f, "phone")
+                << "address" << importField(f, "address")
+                << finalize);
+        } else {
+            profiles.push_back(document{}
+                << "_id" << account->profileOid
+                << "userId" << userId
+                << "name" << importField(f, "name")
+                << "email" << importField(f, "email")
+                << "department" << importField(f, "department", "General")
+                << "specialization" << importField(f, "specialization", "General Practice")
+                << "experience" << atoi(importField(f, "experience", "0").c_str())
+                << "schedule" << open_array << close_array
+                << finalize);
+        }
+        wallets.push_back(document{}
+            << "userId" << userId
+            << "balance" << 0.0
+            << "transactions" << open_array << close_array
+            << "ledgerMigrated" << true
+            << finalize);
+    }
+    
+    // The batch's users, profiles and wallets commit together, as
+    // createAccount does for one account, so neither a failure nor a crash
+    // leaves a user behind without its profile and wallet
+    bool committed = accepted.empty();
+    if(!committed) {
+        auto session = client.start_session();
+        try {
+            session.with_transaction([&](mongocxx::client_session* txn) {
+                db["users"].insert_many(*txn, users);
+                db[kind].insert_many(*txn, profiles);
+                db["wallets"].insert_many(*txn, wallets);
+            });
+            committed = true;
+        } catch(const mongocxx::operation_exception& e) {
+            if(e.code().value() != DUPLICATE_KEY_ERROR) throw;
+        }
+    }
+    
+    vector<PendingAccount*> imported;
+    if(committed) {
+        imported = accepted;
+    } else {
+        // An email registered after the check aborted the batch; retry one
+        // transaction per account so only the clashing rows fail
+        for(size_t i = 0; i < accepted.size(); i++) {
+            if(createAccount(client, users[i].view(), accepted[i]->userOid.to_string(), kind, profiles[i].view())) {
+                imported.push_back(accepted[i]);
+            } else {
+                report.fail(accepted[i]->row, "email already registered");
+            }
+        }
+    }
+    report.imported += (int)imported.size();
+    onImported(imported);
+    
+    batch.clear();
+}
+
+// ============================================================================
+// REPORT EXPORT (cursor batches spooled to disk, streamed by Crow)
+// ============================================================================
+// Crow cannot stream a dynamic chunked body, but it sends static files from
+// disk in small chunks. Exports therefore walk the Mongo cursor in batches,
+// write rows through a fixed-size buffer into a spool file and hand that file
+// to Crow, so memory stays flat however many rows are exported. The client
+// gets its first byte only once the scan finishes. A sweeper thread deletes
+// spool files once they are older than EXPORT_FILE_TTL_SECONDS.
+
+const size_t EXPORT_FLUSH_BYTES = 64 * 1024;
+const int EXPORT_CURSOR_BATCH = 1000;
+const int MAX_CONCURRENT_EXPORTS = 2;
+const int EXPORT_FILE_TTL_SECONDS = 15 * 60;
+const int EXPORT_SWEEP_INTERVAL_SECONDS = 60;
+
+struct ExportColumn {
+    const char* name;
+    const char* field;
+};
+
+const vector<ExportColumn> APPOINTMENT_EXPORT_COLUMNS = {
+    {"id", "_id"}, {"patientUserId", "patientUserId"}, {"doctorUserId", "doctorUserId"},
+    {"date", "date"}, {"time", "time"}, {"reason", "reason"},
+    {"status", "status"}, {"rejectionReason", "rejectionReason"}
+};
+
+const vector<ExportColumn> TRANSACTION_EXPORT_COLUMNS = {
+    {"id", "_id"}, {"userId", "userId"}, {"amount", "amount"},
+    {"type", "type"}, {"description", "description"}, {"timestamp", "timestamp"}
+};
+
+// YYYY-MM-DD, as stored on appointments and prefixing ledger timestamps
+bool isIsoDate(const string& date) {
+    if(date.size() != 10 || date[4] != '-' || date[7] != '-') return false;
+    for(int i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+        if(!isdigit(static_cast<unsigned char>(date[i]))) return false;
+    }
+    return true;
+}
+
+string nextIsoDate(const string& date) {
+    tm day = {};
+    day.tm_year = atoi(date.substr(0, 4).c_str()) - 1900;
+    day.tm_mon = atoi(date.substr(5, 2).c_str()) - 1;
+    day.tm_mday = atoi(date.substr(8, 2).c_str()) + 1;
+    day.tm_hour = 12;
+    mktime(&day);
+    char buf[11];
+    strftime(buf, sizeof(buf), "%Y-%m-%d", &day);
+    return buf;
+}
+
+class ExportSpool {
+private:
+    FILE* file;
+    string buffer;
+    bool csv;
+    const vector<ExportColumn>& columns;
+    size_t rows;
+    
+    void flush() {
+        if(buffer.empty()) return;
+        if(fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+            throw runtime_error("export spool write failed");
+        }
+        buffer.clear();
+    }
+    
+    void appendCsv(const string& text) {
+        if(text.find_first_of(",\"\r\n") == string::npos) {
+            buffer += text;
+            return;
+        }
+        buffer += '"';
+        for(char c : text) {
+            if(c == '"') buffer += '"';
+            buffer += c;
+        }
+        buffer += '"';
+    }
+    
+public:
+    ExportSpool(const string& path, bool csv, const vector<ExportColumn>& columns)
+        : file(fopen(path.c_str(), "wb")), csv(csv), columns(columns), rows(0) {
+        if(!file) throw runtime_error("cannot create export spool file");
+        buffer.reserve(EXPORT_FLUSH_BYTES + 4096);
+        if(csv) {
+            for(size_t i = 0; i < columns.size(); i++) {
+                if(i > 0) buffer += ',';
+                buffer += columns[i].name;
+            }
+            buffer += '\n';
+        }
+    }
+    
+    ~ExportSpool() {
+        if(file) fclose(file);
+    }
+    
+    void write(const bsoncxx::document::view& doc) {
+        if(csv) {
+            for(size_t i = 0; i < columns.size(); i++) {
+                if(i > 0) buffer += ',';
+                auto elem = doc[columns[i].field];
+                if(!elem) continue;
+                switch(elem.type()) {
+                    case bsoncxx::type::k_oid: buffer += elem.get_oid().value.to_string(); break;
+                    case bsoncxx::type::k_string: appendCsv(string(elem.get_string().value)); break;
+                    case bsoncxx::type::k_int32: buffer += to_string(elem.get_int32().value); break;
+                    case bsoncxx::type::k_int64: buffer += to_string(elem.get_int64().value); break;
+                    case bsoncxx::type::k_double: {
+                        char num[32];
+                        snprintf(num, sizeof(num), "%.15g", elem.get_double().value);
+                        buffer += num;
+                        break;
+                    }
+                    default: break;
+                }
+            }
+        } else {
+            JsonWriter json(buffer);
+            json.beginObject();
+            for(auto& column : columns) {
+                auto elem = doc[column.field];
+                json.key(column.name);
+                if(!elem) {
+                    json.nullValue();
+                    continue;
+                }
+                switch(elem.type()) {
+                    case bsoncxx::type::k_oid: json.value(elem.get_oid().value.to_string()); break;
+                    case bsoncxx::type::k_string: json.value(elem.get_string().value); break;
+                    case bsoncxx::type::k_int32: json.value(elem.get_int32().value); break;
+                    case bsoncxx::type::k_int64: json.value((long long)elem.get_int64().value); break;
+                    case bsoncxx::type::k_double: json.value(elem.get_double().value); break;
+                    default: json.nullValue(); break;
+                }
+            }
+            json.endObject();
+        }
+        buffer += '\n';
+        rows++;
+        
+        if(buffer.size() >= EXPORT_FLUSH_BYTES) flush();
+    }
+    
+    void close() {
+        flush();
+        if(fclose(file) != 0) {
+            file = nullptr;
+            throw runtime_error("export spool close failed");
+        }
+        file = nullptr;
+    }
+    
+    size_t rowCount() const { return rows; }
+};
+
+// HMS_EXPORT_DIR or <tmp>/hms_exports
+std::filesystem::path exportSpoolDir() {
+    namespace fs = std::filesystem;
+    const char* configured = getenv("HMS_EXPORT_DIR");
+    fs::path dir = configured && *configured ? fs::path(configured) : fs::temp_directory_path() / "hms_exports";
+    fs::create_directories(dir);
+    return dir;
+}
+
+string newExportSpoolPath(const string& kind, const string& format) {
+    return (exportSpoolDir() / (kind + "-" + bsoncxx::oid().to_string() + "." + format)).string();
+}
+
+// Removes spool files past their TTL. A file Crow is still sending stays
+// readable on POSIX; elsewhere the remove fails and the next sweep retries.
+void sweepExportSpool() {
+    namespace fs = std::filesystem;
+    auto cutoff = fs::file_time_type::clock::now() - chrono::seconds(EXPORT_FILE_TTL_SECONDS);
+    error_code ec;
+    for(auto& entry : fs::directory_iterator(exportSpoolDir(), ec)) {
+        if(entry.is_regular_file(ec) && entry.last_write_time(ec) < cutoff) {
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
+// ============================================================================
+// AVAILABILITY SEARCH (schedule bitsets AND NOT booked bitsets)
+// ============================================================================
+// A doctor's free slots on a day are workingSlots[weekday] & ~bookedSlots,
+// both 48-bit masks, so a search never touches Mongo. Days are walked in
+// order and each day slot by slot across doctors, so the first `limit`
+// slots found are the earliest.
+
+const int AVAILABILITY_MAX_DAYS = 31;
+const int AVAILABILITY_DEFAULT_DAYS = 7;
+
+struct OpenSlot {
+    string date;
+    int minute;
+    const DoctorEntry* doctor;
+};
+
+bool sameDepartment(const string& a, const string& b) {
+    return a.size() == b.size() && equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return tolower(static_cast<unsigned char>(x)) == tolower(static_cast<unsigned char>(y));
+    });
+}
+
+int isoWeekday(const string& date) {
+    tm day = {};
+    day.tm_year = atoi(date.substr(0, 4).c_str()) - 1900;
+    day.tm_mon = atoi(date.substr(5, 2).c_str()) - 1;
+    day.tm_mday = atoi(date.substr(8, 2).c_str());
+    day.tm_hour = 12;
+    mktime(&day);
+    return day.tm_wday;
+}
+
+// from/to are inclusive YYYY-MM-DD, from not before today; slots already
+// started today are skipped
+vector<OpenSlot> findOpenSlots(const DoctorSnapshot& roster, DoctorSlotIndex& slotIndex,
+                               const string& department, const string& from, const string& to,
+                               int limit) {
+    vector<const DoctorEntry*> doctors;
+    for(auto& key : roster.orders.at("name")) {
+        const DoctorEntry& d = roster.doctors[key.index];
+        if(department.empty() || sameDepartment(d.department, department)) doctors.push_back(&d);
+    }
+    
+    time_t now = time(nullptr);
+    tm local = *localtime(&now);
+    char today[11];
+    strftime(today, sizeof(today), "%Y-%m-%d", &local);
+    int firstFutureSlot = (local.tm_hour * 60 + local.tm_min) / APPOINTMENT_SLOT_MINUTES + 1;
+    
+    vector<OpenSlot> found;
+    vector<DaySlotMask> free(doctors.size());
+    for(string date = from; date <= to && (int)found.size() < limit; date = nextIsoDate(date)) {
+        int wday = isoWeekday(date);
+        int32_t day = (int32_t)(makeDateTimeKey(date, "") / 10000);
+        
+        DaySlotMask notPast;
+        notPast.set();
+        if(date == today) notPast <<= min(firstFutureSlot, SLOTS_PER_DAY);
+        
+        bool any = false;
+        for(size_t i = 0; i < doctors.size(); i++) {
+            free[i] = doctors[i]->workingSlots[wday] & notPast;
+            if(free[i].any()) free[i] &= ~slotIndex.bookedSlots(doctors[i]->userId, day);
+            any = any || free[i].any();
+        }
+        if(!any) continue;
+        
+        for(int slot = 0; slot < SLOTS_PER_DAY && (int)found.size() < limit; slot++) {
+            for(size_t i = 0; i < doctors.size() && (int)found.size() < limit; i++) {
+                if(free[i].test(slot)) found.push_back({date, slot * APPOINTMENT_SLOT_MINUTES, doctors[i]});
+            }
+        }
+    }
+    return found;
+}
+
+// ============================================================================
+// MAIN APPLICATION
+// ============================================================================
+
+int main() {
+    crow::App<CORSMiddleware, AuthMiddleware> app;
+    
+    auto tokenSigner = make_shared<TokenSigner>(loadTokenSecret(), 12 * 60 * 60, 4096);
+    size_t serverThreads = max(8u, thread::hardware_concurrency());
+    size_t hashAdmission = serverThreads / 4;
+    size_t hashWorkers = min(hashAdmission, (size_t)max(2u, thread::hardware_concurrency() / 4));
+    auto passwordHasher = make_shared<PasswordHasher>(hashWorkers, hashAdmission);
+    auto importLock = make_shared<mutex>();
+    auto activeExports = make_shared<atomic<int>>(0);
+    app.get_middleware<AuthMiddleware>().signer = tokenSigner;
+    
+    // DSA Data Structures
+    auto patientIndex = make_shared<PatientIndex>();
+    auto doctorQueues = make_shared<DoctorQueues>();
+    auto recordIndex = make_shared<MedicalRecordIndex>();
+    auto walletJournal = make_shared<WalletUndoJournal>(20);
+    auto identityCache = make_shared<IdentityCache>(10000);
+    auto doctorRoster = make_shared<DoctorRoster>();
+    auto slotIndex = make_shared<DoctorSlotIndex>();
+    auto triageQueue = make_shared<TriageQueue>();
+    
+    // THREAD-SAFE MongoDB Connection Pool
+    mongocxx::instance instance{};
+    // Account creation uses multi-document transactions, which need a replica
+    // set; a single-node one is enough (mongod --replSet rs0, rs.initiate())
+    mongocxx::uri uri{"mongodb://localhost:27017/?replicaSet=rs0"};
+    mongocxx::pool pool{uri};
+    
+    // Export spool files are deleted on a timer once past their TTL
+    thread([]() {
+        while(true) {
+            try {
+                sweepExportSpool();
+            } catch(const exception& e) {
+                CROW_LOG_ERROR << "Export spool sweep failed: " << e.what();
+            }
+            this_thread::sleep_for(chrono::seconds(EXPORT_SWEEP_INTERVAL_SECONDS));
+        }
+    }).detach();
+    
+    // The routes answer from these indexes, so serving with any of them empty
+    // would be wrong; retry while Mongo comes up, then refuse to start
+    const int STARTUP_LOAD_ATTEMPTS = 5;
+    for(int attempt = 1; ; attempt++) {
+        try {
+            auto client_conn = pool.acquire();
+            auto db = (*client_conn)["hospital_management"];
+            migrateWalletLedger(db);
+            normalizeAppointmentTimes(db);
+            walletJournal->load(db);
+            patientIndex->load(db);
+            slotIndex->load(db);
+            triageQueue->load(db);
+            doctorQueues->load(db);
+            recordIndex->load(db);
+            CROW_LOG_INFO << "Patient index loaded: " << patientIndex->size() << " patients";
+            break;
+        } catch(const exception& e) {
+            CROW_LOG_ERROR << "Startup index load failed (attempt " << attempt << "/"
+                           << STARTUP_LOAD_ATTEMPTS << "): " << e.what();
+            if(attempt == STARTUP_LOAD_ATTEMPTS) return 1;
+            this_thread::sleep_for(chrono::seconds(2 * attempt));
+            
+            // A partial load must not leave duplicates behind for the retry
+            walletJournal = make_shared<WalletUndoJournal>(20);
+            patientIndex = make_shared<PatientIndex>();
+            slotIndex = make_shared<DoctorSlotIndex>();
+            triageQueue = make_shared<TriageQueue>();
+            doctorQueues = make_shared<DoctorQueues>();
+            recordIndex = make_shared<MedicalRecordIndex>();
+        }
+    }
+
+    
+    CROW_LOG_INFO << "========================================";
+    CROW_LOG_INFO << "Hospital Management System - DSA Active";
+    CROW_LOG_INFO << "Custom: LinkedList, Queue, IndexedQueue, Stack, B+-Tree, Indexed Heap";
+    CROW_LOG_INFO << "Algorithms: QuickSort, MergeSort, BinarySearch";
+    CROW_LOG_INFO << "MongoDB: Thread-Safe Connection Pool";
+    CROW_LOG_INFO << "========================================";
+    
+    // ========================================================================
+    // REGISTER
+    // ========================================================================
+    // Self-registration is unauthenticated, so it only ever creates patients.
+    // Staff accounts come from the admin-only /api/staff and /api/doctors.
+    CROW_ROUTE(app, "/api/register").methods("POST"_method)
+    ([&pool, &tokenSigner, &passwordHasher, &patientIndex, &identityCache](const crow::request& req) {
+        auto x = crow::json::load(req.body);
+        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+        
+        try {
+            string email = getString(x["email"]);
+            string password = getString(x["password"]);
+            string role = x.has("role") ? getString(x["role"]) : "patient";
+            string name = getString(x["name"]);
+            
+            if(role != "patient") {
+                return crow::response(403, "{\"error\":\"Only patient accounts can self-register\"}");
+            }
+            
+            string passwordHash;
+            if(!passwordHasher->run([&]() { passwordHash = hashPassword(password); })) {
+                return passwordHasherBusy();
+            }
+            
+            bsoncxx::oid userOid;
+            string userId = userOid.to_string();
+            auto userDoc = document{}
+                << "_id" << userOid
+                << "email" << email
+                << "password" << passwordHash
+                << "role" << role
+                << "name" << name
+                << finalize;
+            
+            bsoncxx::oid patientOid;
+            auto profileDoc = document{}
+                << "_id" << patientOid
+                << "userId" << userId
+                << "name" << name
+                << "email" << email
+                << "age" << 0
+                << "gender" << "not specified"
+                << "phone" << ""
+                << "address" << ""
+                << finalize;
+            
+            auto client_conn = pool.acquire();
+            if(!createAccount(*client_conn, userDoc.view(), userId, "patients", profileDoc.view())) {
+                return crow::response(409, "{\"error\":\"User already exists\"}");
+            }
+            identityCache->invalidate(userId);
+            
+            PatientRecord pr;
+            pr.id = patientOid.to_string();
+            pr.userId = userId;
+            pr.name = name;
+            pr.email = email;
+            pr.age = 0;
+            pr.gender = "not specified";
+            patientIndex->upsert(pr);
+            
+            crow::json::wvalue r;
+            r["success"] = true;
+            r["token"] = tokenSigner->sign(userId, role);
+            r["userId"] = userId;
+            r["role"] = role;
+            r["name"] = name;
+            
+            crow::response res(201);
+            res.set_header("Content-Type", "application/json");
+            res.write(r.dump());
+            return res;
+            
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // STAFF ACCOUNTS (admin only)
+    // ========================================================================
+    CROW_ROUTE(app, "/api/staff").methods("POST"_method)
+    ([&app, &pool, &passwordHasher, &identityCache](const crow::request& req) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role != "admin") {
+            return crow::response(403, "{\"error\":\"Only admins can create staff accounts\"}");
+        }
+        
+        auto x = crow::json::load(req.body);
+        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+        
+        try {
+            string email = getString(x["email"]);
+            string password = getString(x["password"]);
+            string role = getString(x["role"]);
+            string name = getString(x["name"]);
+            
+            if(role != "admin" && role != "receptionist") {
+                return crow::response(400, "{\"error\":\"role must be admin or receptionist\"}");
+            }
+            
+            string passwordHash;
+            if(!passwordHasher->run([&]() { passwordHash = hashPassword(password); })) {
+                return passwordHasherBusy();
+            }
+            
+            bsoncxx::oid userOid;
+            string userId = userOid.to_string();
+            auto userDoc = document{}
+                << "_id" << userOid
+                << "email" << email
+                << "password" << passwordHash
+                << "role" << role
+                << "name" << name
+                << finalize;
+            
+            auto noProfile = document{} << finalize;
+            auto client_conn = pool.acquire();
+            if(!createAccount(*client_conn, userDoc.view(), userId, "", noProfile.view())) {
+                return crow::response(409, "{\"error\":\"User already exists\"}");
+            }
+            identityCache->invalidate(userId);
+            
+            crow::json::wvalue r;
+            r["success"] = true;
+            r["userId"] = userId;
+            r["role"] = role;
+            r["name"] = name;
+            
+            crow::response res(201);
+            res.set_header("Content-Type", "application/json");
+            res.write(r.dump());
+            return res;
+            
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // LOGIN
+    // ========================================================================
+    CROW_ROUTE(app, "/api/login").methods("POST"_method)
+    ([&pool, &tokenSigner, &passwordHasher](const crow::request& req) {
+        auto x = crow::json::load(req.body);
+        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+        
+        try {
+            auto client_conn = pool.acquire();
+            auto db = (*client_conn)["hospital_management"];
+            
+            string email = getString(x["email"]);
+            string password = getString(x["password"]);
+            
+            auto users = db["users"];
+            auto userDoc = users.find_one(document{} << "email" << email << finalize);
+            
+            if(!userDoc) {
+                return crow::response(401, "{\"error\":\"Invalid credentials\"}");
+            }
+            
+            auto view = userDoc->view();
+            string stored = getStringValue(view["password"]);
+            bool valid = false;
+            string upgradedHash;
+            bool accepted = passwordHasher->run([&]() {
+                bool needsRehash = false;
+                valid = verifyPassword(password, stored, needsRehash);
+                if(valid && needsRehash) upgradedHash = hashPassword(password);
+            });
+            if(!accepted) {
+                return passwordHasherBusy();
+            }
+            if(!valid) {
+                return crow::response(401, "{\"error\":\"Invalid credentials\"}");
+            }
+            
+            if(!upgradedHash.empty()) {
+                users.update_one(
+                    document{} << "_id" << view["_id"].get_oid().value << finalize,
+                    document{} << "$set" << open_document << "password" << upgradedHash << close_document << finalize
+                );
+            }
+            
+            string userId = view["_id"].get_oid().value.to_string();
+            string role = getStringValue(view["role"]);
+            string name = getStringValue(view["name"]);
+            
+            crow::json::wvalue r;
+            r["success"] = true;
+            r["token"] = tokenSigner->sign(userId, role);
+            r["userId"] = userId;
+            r["role"] = role;
+            r["name"] = name;
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(r.dump());
+            return res;
+            
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // PATIENTS - GET ALL (DSA: Snapshot Index, keyset paginated on _id)
+    // ========================================================================
+    CROW_ROUTE(app, "/api/patients").methods("GET"_method)
+    ([&app, &patientIndex](const crow::request& req) {
+        if(app.get_context<AuthMiddleware>(req).role == "patient") {
+            return crow::response(403, "{\"error\":\"Patients cannot list other patients\"}");
+        }
+        
+        try {
+            int limit = parsePageLimit(req);
+            
+            string afterId;
+            auto cursorParam = req.url_params.get("cursor");
+            if(cursorParam) {
+                vector<string> parts;
+                if(!decodeCursor(cursorParam, 1, parts)) {
+                    return crow::response(400, "{\"error\":\"Invalid cursor\"}");
+                }
+                afterId = parts[0];
+            }
+            
+            bool hasMore = false;
+            auto patients = patientIndex->page(afterId, limit, hasMore);
+            
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("patients").beginArray();
+            
+            for(auto& pr : patients) {
+                writePatientProfile(json, *pr);
+            }
+            
+            json.endArray()
+                .field("hasMore", hasMore)
+                .field("nextCursor", hasMore ? encodeCursor({patients.back()->id}) : "")
+                .field("dsaUsed", "Copy-on-Write Snapshot Index - O(page) merge, no rebuild")
+                .field("indexSize", (long long)patientIndex->size())
+                .endObject();
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // PATIENTS - GET BY USER (DSA: Snapshot Index Hash Lookup)
+    // ========================================================================
+    CROW_ROUTE(app, "/api/patients/by-user/<string>").methods("GET"_method)
+    ([&app, &patientIndex](const crow::request& req, string userId) {
+        try {
+            auto& session = app.get_context<AuthMiddleware>(req);
+            auto pr = patientIndex->findByUserId(userId);
+            if(!pr || (session.role == "patient" && session.userId != userId)) {
+                return crow::response(404, "{\"error\":\"Patient not found\"}");
+            }
+            
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("patient");
+            writePatientProfile(json, *pr);
+            json.field("dsaUsed", "Snapshot Index Hash Lookup - O(1)")
+                .endObject();
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // PATIENTS - MEDICAL RECORDS (DSA: B+-Tree Range Scan)
+    // ========================================================================
+    // <id> is the patient profile id or the patient's user id
+    CROW_ROUTE(app, "/api/patients/<string>/records").methods("GET"_method)
+    ([&app, &patientIndex, &recordIndex](const crow::request& req, string patientId) {
+        try {
+            auto& session = app.get_context<AuthMiddleware>(req);
+            auto pr = patientIndex->findById(patientId);
+            if(!pr) pr = patientIndex->findByUserId(patientId);
+            // Another patient's id answers exactly like an unknown one, so
+            // patients cannot probe which ids exist.
+            if(!pr || (session.role == "patient" && session.userId != pr->userId)) {
+                return crow::response(404, "{\"error\":\"Patient not found\"}");
+            }
+            
+            string from, to = "~";
+            if(req.url_params.get("from")) {
+                from = req.url_params.get("from");
+                if(!isIsoDate(from)) return crow::response(400, "{\"error\":\"from must be YYYY-MM-DD\"}");
+            }
+            if(req.url_params.get("to")) {
+                string lastDay = req.url_params.get("to");
+                if(!isIsoDate(lastDay)) return crow::response(400, "{\"error\":\"to must be YYYY-MM-DD\"}");
+                to = nextIsoDate(lastDay);
+            }
+            
+            string afterTimestamp, afterId;
+            auto cursorParam = req.url_params.get("cursor");
+            if(cursorParam) {
+                vector<string> parts;
+                if(!decodeCursor(cursorParam, 2, parts)) {
+                    return crow::response(400, "{\"error\":\"Invalid cursor\"}");
+                }
+                afterTimestamp = parts[0];
+                afterId = parts[1];
+            }
+            
+            bool hasMore;
+            auto records = recordIndex->range(pr->userId, from, to, afterTimestamp, afterId,
+                                              parsePageLimit(req), hasMore);
+            string nextCursor;
+            if(hasMore) nextCursor = encodeCursor({records.back()->timestamp, records.back()->id});
+            
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("records").beginArray();
+            for(auto& record : records) writeMedicalRecord(json, *record);
+            json.endArray()
+                .field("patientUserId", pr->userId)
+                .field("hasMore", hasMore)
+                .field("nextCursor", nextCursor)
+                .field("dsaUsed", "B+-Tree Range Scan on (patient, timestamp) - O(log n + k)")
+                .endObject();
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    CROW_ROUTE(app, "/api/patients/<string>/records").methods("POST"_method)
+    ([&app, &pool, &patientIndex, &recordIndex](const crow::request& req, string patientId) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role != "doctor" && session.role != "admin") {
+            return crow::response(403, "{\"error\":\"Only doctors can add medical records\"}");
+        }
+        
+        auto x = crow::json::load(req.body);
+        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+        
+        try {
+            auto pr = patientIndex->findById(patientId);
+            if(!pr) pr = patientIndex->findByUserId(patientId);
+            if(!pr) {
+                return crow::response(404, "{\"error\":\"Patient not found\"}");
+            }
+            
+            auto record = make_shared<MedicalRecord>();
+            record->patientUserId = pr->userId;
+            record->doctorUserId = session.userId;
+            record->type = x.has("type") ? getString(x["type"]) : "";
+            record->summary = x.has("summary") ? getString(x["summary"]) : "";
+            record->details = x.has("details") ? getString(x["details"]) : "";
+            record->appointmentId = x.has("appointmentId") ? getString(x["appointmentId"]) : "";
+            record->medication = x.has("medication") ? getString(x["medication"]) : "";
+            record->dosage = x.has("dosage") ? getString(x["dosage"]) : "";
+            record->timestamp = getCurrentTimestamp();
+            
+            if(find(MEDICAL_RECORD_TYPES.begin(), MEDICAL_RECORD_TYPES.end(), record->type) == MEDICAL_RECORD_TYPES.end()) {
+                return crow::response(400, "{\"error\":\"type must be visit, diagnosis or prescription\"}");
+            }
+            if(record->summary.empty()) {
+                return crow::response(400, "{\"error\":\"summary is required\"}");
+            }
+            if(record->type == "prescription" && record->medication.empty()) {
+                return crow::response(400, "{\"error\":\"Prescriptions need a medication\"}");
+            }
+            
+            bsoncxx::oid recordOid;
+            record->id = recordOid.to_string();
+            
+            auto client_conn = pool.acquire();
+            auto db = (*client_conn)["hospital_management"];
+            db["medical_records"].insert_one(document{}
+                << "_id" << recordOid
+                << "patientUserId" << record->patientUserId
+                << "doctorUserId" << record->doctorUserId
+                << "appointmentId" << record->appointmentId
+                << "type" << record->type
+                << "timestamp" << record->timestamp
+                << "summary" << record->summary
+                << "details" << record->details
+                << "medication" << record->medication
+                << "dosage" << record->dosage
+                << finalize);
+            recordIndex->add(record);
+            
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().field("success", true).key("record");
+            writeMedicalRecord(json, *record);
+            json.field("dsaUsed", "B+-Tree Insert - O(log n)")
+                .endObject();
+            
+            crow::response res(201);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // PATIENTS - POST (DSA: Snapshot Index Insert)
+    // ========================================================================
+    CROW_ROUTE(app, "/api/patients").methods("POST"_method)
+    ([&app, &pool, &passwordHasher, &patientIndex, &identityCache](const crow::request& req) {
+        if(!isOfficeStaff(app.get_context<AuthMiddleware>(req))) {
+            return crow::response(403, "{\"error\":\"Only admin or reception staff can add patients\"}");
+        }
+        
+        auto x = crow::json::load(req.body);
+        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+        
+        try {
+            string name = getString(x["name"]);
+            string email = getString(x["email"]);
+            string password = getString(x["password"]);
+            int age = x["age"].i();
+            string gender = getString(x["gender"]);
+            string phone = getString(x["phone"]);
+            string address = getString(x["address"]);
+            
+            string passwordHash;
+            if(!passwordHasher->run([&]() { passwordHash = hashPassword(password); })) {
+                return passwordHasherBusy();
+            }
+            
+            bsoncxx::oid userOid;
+            bsoncxx::oid patientOid;
+            string userId = userOid.to_string();
+            
+            auto userDoc = document{}
+                << "_id" << userOid
+                << "email" << email
+                << "password" << passwordHash
+                << "role" << "patient"
+                << "name" << name
+                << finalize;
+            
+            auto patientDoc = document{}
+                << "_id" << patientOid
+                << "userId" << userId
+                << "name" << name
+                << "email" << email
+                << "age" << age
+                << "gender" << gender
+                << "phone" << phone
+                << "address" << address
+                << finalize;
+            
+            auto client_conn = pool.acquire();
+            if(!createAccount(*client_conn, userDoc.view(), userId, "patients", patientDoc.view())) {
+                return crow::response(409, "{\"error\":\"User already exists\"}");
+            }
+            identityCache->invalidate(userId);
+            
+            PatientRecord pr;
+            pr.id = patientOid.to_string();
+            pr.userId = userId;
+            pr.name = name;
+            pr.email = email;
+            pr.age = age;
+            pr.gender = gender;
+            pr.phone = phone;
+            pr.address = address;
+            patientIndex->upsert(pr);
+            
+            crow::json::wvalue r;
+            r["success"] = true;
+            r["patientId"] = pr.id;
+            r["dsaUsed"] = "Snapshot Index Insert - O(n / shards)";
+            
+            crow::response res(201);
+            res.set_header("Content-Type", "application/json");
+            res.write(r.dump());
+            return res;
+            
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+
+    // ========================================================================
+    // PATIENTS - DELETE
+    // ========================================================================
+    CROW_ROUTE(app, "/api/patients/<string>").methods("DELETE"_method)
+    ([&app, &pool, &patientIndex, &identityCache](const crow::request& req, string patientId) {
+        if(!isOfficeStaff(app.get_context<AuthMiddleware>(req))) {
+            return crow::response(403, "{\"error\":\"Only admin or reception staff can delete patients\"}");
+        }
+        
+        try {
+            auto client_conn = pool.acquire();
+            auto db = (*client_conn)["hospital_management"];
+            
+            auto patients = db["patients"];
+            auto patientDoc = patients.find_one(document{} << "_id" << bsoncxx::oid(patientId) << finalize);
+            
+            if(!patientDoc) {
+                return crow::response(404, "{\"error\":\"Patient not found\"}");
+            }
+            
+            string userId = getStringValue(patientDoc->view()["userId"]);
+            
+            patientIndex->erase(patientId);
+            
+            patients.delete_one(document{} << "_id" << bsoncxx::oid(patientId) << finalize);
+            db["users"].delete_one(document{} << "_id" << bsoncxx::oid(userId) << finalize);
+            db["wallets"].delete_one(document{} << "userId" << userId << finalize);
+            identityCache->invalidate(userId);
+            
+            crow::json::wvalue r;
+            r["success"] = true;
+            r["dsaUsed"] = "Snapshot Index Delete - O(n / shards)";
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(r.dump());
+            return res;
+            
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+// PATIENTS - UPDATE PROFILE (NEW!)
+// ========================================================================
+CROW_ROUTE(app, "/api/patients/<string>").methods("PUT"_method)
+([&app, &pool, &patientIndex](const crow::request& req, string patientId) {
+    auto& session = app.get_context<AuthMiddleware>(req);
+    if(!isOfficeStaff(session) && session.role != "patient") {
+        return crow::response(403, "{\"error\":\"Not allowed to edit patient profiles\"}");
+    }
+    
+    auto x = crow::json::load(req.body);
+    if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+    
+    try {
+        auto client_conn = pool.acquire();
+        auto db = (*client_conn)["hospital_management"];
+        
+        int age = x["age"].i();
+        string gender = getString(x["gender"]);
+        string phone = getString(x["phone"]);
+        string address = getString(x["address"]);
+        
+        mongocxx::options::find_one_and_update opts;
+        opts.return_document(mongocxx::options::return_document::k_after);
+        
+        // A patient's filter also pins the owner, so another patient's id
+        // answers with the same 404 as an unknown one
+        auto filterBuilder = document{};
+        filterBuilder << "_id" << bsoncxx::oid(patientId);
+        if(session.role == "patient") filterBuilder << "userId" << session.userId;
+        
+        auto patients = db["patients"];
+        auto patientDoc = patients.find_one_and_update(
+            filterBuilder.view(),
+            document{} << "$set" << open_document
+                << "age" << age
+                << "gender" << gender
+                << "phone" << phone
+                << "address" << address
+            << close_document << finalize,
+            opts
+        );
+        
+        if(!patientDoc) {
+            return crow::response(404, "{\"error\":\"Patient not found\"}");
+        }
+        patientIndex->upsert(patientFromBson(patientDoc->view()));
+        
+        return crow::response(200, "{\"success\":true}");
+        
+    } catch(const exception& e) {
+        return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+    }
+});
+    // ========================================================================
+    // DOCTORS - GET ALL (DSA: IntroSort on typed keys, keyset paginated)
+    // ========================================================================
+    CROW_ROUTE(app, "/api/doctors").methods("GET"_method)
+    ([&pool, &doctorRoster](const crow::request& req) {
+        try {
+            string sortBy = req.url_params.get("sortBy") ? req.url_params.get("sortBy") : "name";
+            if(find(DOCTOR_SORT_FIELDS.begin(), DOCTOR_SORT_FIELDS.end(), sortBy) == DOCTOR_SORT_FIELDS.end()) {
+                return crow::response(400, "{\"error\":\"sortBy must be name, department or experience\"}");
+            }
+            
+            auto client_conn = pool.acquire();
+            auto db = (*client_conn)["hospital_management"];
+            
+            auto snapshot = doctorRoster->current(db);
+            const auto& order = snapshot->orders.at(sortBy);
+            
+            int limit = parsePageLimit(req);
+            auto start = order.begin();
+            
+            auto cursorParam = req.url_params.get("cursor");
+            if(cursorParam) {
+                vector<string> parts;
+                if(!decodeCursor(cursorParam, 4, parts)) {
+                    return crow::response(400, "{\"error\":\"Invalid cursor\"}");
+                }
+                DoctorSortKey after;
+                after.primary = parts[0];
+                after.rank = atoi(parts[1].c_str());
+                after.secondary = parts[2];
+                after.id = parts[3];
+                start = upper_bound(order.begin(), order.end(), after);
+            }
+            
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("doctors").beginArray();
+            
+            auto it = start;
+            for(int served = 0; it != order.end() && served < limit; ++it, served++) {
+                const DoctorEntry& d = snapshot->doctors[it->index];
+                json.beginObject()
+                    .field("id", d.id)
+                    .field("userId", d.userId)
+                    .field("name", d.name)
+                    .field("email", d.email)
+                    .field("department", d.department)
+                    .field("specialization", d.specialization)
+                    .field("experience", d.experience);
+                
+                json.key("schedule").beginArray();
+                for(auto& day : d.schedule) {
+                    json.beginObject()
+                        .field("day", day.first)
+                        .field("hours", day.second)
+                        .endObject();
+                }
+                json.endArray().endObject();
+            }
+            
+            bool hasMore = it != order.end();
+            string nextCursor;
+            if(hasMore) {
+                const DoctorSortKey& last = *(it - 1);
+                nextCursor = encodeCursor({last.primary, to_string(last.rank), last.secondary, last.id});
+            }
+            
+            json.endArray()
+                .field("hasMore", hasMore)
+                .field("nextCursor", nextCursor)
+                .field("sortBy", sortBy)
+                .field("dsaUsed", "IntroSort on typed keys (once per roster change) - O(log n) seek")
+                .endObject();
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // DOCTORS - GET BY USER (userId index, projected single document)
+    // ========================================================================
+    CROW_ROUTE(app, "/api/doctors/by-user/<string>").methods("GET"_method)
+    ([&pool](const crow::request& req, string userId) {
+        try {
+            auto client_conn = pool.acquire();
+            auto db = (*client_conn)["hospital_management"];
+            
+            auto doctorDoc = findDoctorByUserId(db, userId);
+            if(!doctorDoc) {
+                return crow::response(404, "{\"error\":\"Doctor not found\"}");
+            }
+            
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("doctor");
+            writeDoctorProfile(json, doctorDoc->view());
+            json.field("dsaUsed", "B-Tree index seek on userId - O(log n)").endObject();
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // DOCTORS - POST
+    // ========================================================================
+    CROW_ROUTE(app, "/api/doctors").methods("POST"_method)
+    ([&app, &pool, &passwordHasher, &identityCache, &doctorRoster](const crow::request& req) {
+        if(app.get_context<AuthMiddleware>(req).role != "admin") {
+            return crow::response(403, "{\"error\":\"Only admins can add doctors\"}");
+        }
+        
+        auto x = crow::json::load(req.body);
+        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+        
+        try {
+            string name = getString(x["name"]);
+            string email = getString(x["email"]);
+            string password = getString(x["password"]);
+            string department = getString(x["department"]);
+            string specialization = getString(x["specialization"]);
+            int experience = x["experience"].i();
+            
+            string passwordHash;
+            if(!passwordHasher->run([&]() { passwordHash = hashPassword(password); })) {
+                return passwordHasherBusy();
+            }
+            
+            bsoncxx::oid userOid;
+            string userId = userOid.to_string();
+            
+            auto userDoc = document{}
+                << "_id" << userOid
+                << "email" << email
+                << "password" << passwordHash
+                << "role" << "doctor"
+                << "name" << name
+                << finalize;
+            
+            auto doctorDoc = document{}
+                << "userId" << userId
+                << "name" << name
+                << "email" << email
+                << "department" << department
+                << "specialization" << specialization
+                << "experience" << experience
+                << "schedule" << open_array << close_array
+                << finalize;
+            
+            auto client_conn = pool.acquire();
+            if(!createAccount(*client_conn, userDoc.view(), userId, "doctors", doctorDoc.view())) {
+                return crow::response(409, "{\"error\":\"User already exists\"}");
+            }
+            identityCache->invalidate(userId);
+            doctorRoster->invalidate();
+            
+            return crow::response(201, "{\"success\":true}");
+            
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // DOCTORS - DELETE
+    // ========================================================================
+    CROW_ROUTE(app, "/api/doctors/<string>").methods("DELETE"_method)
+    ([&app, &pool, &identityCache, &doctorRoster](const crow::request& req, string doctorId) {
+        if(app.get_context<AuthMiddleware>(req).role != "admin") {
+            return crow::response(403, "{\"error\":\"Only admins can delete doctors\"}");
+        }
+        
+        try {
+            auto client_conn = pool.acquire();
+            auto db = (*client_conn)["hospital_management"];
+            
+            auto doctors = db["doctors"];
+            auto doctorDoc = doctors.find_one(document{} << "_id" << bsoncxx::oid(doctorId) << finalize);
+            
+            if(!doctorDoc) {
+                return crow::response(404, "{\"error\":\"Doctor not found\"}");
+            }
+            
+            string userId = getStringValue(doctorDoc->view()["userId"]);
+            
+            doctors.delete_one(document{} << "_id" << bsoncxx::oid(doctorId) << finalize);
+            doctorRoster->invalidate();
+            db["users"].delete_one(document{} << "_id" << bsoncxx::oid(userId) << finalize);
+            db["wallets"].delete_one(document{} << "userId" << userId << finalize);
+            identityCache->invalidate(userId);
+            
+            return crow::response(200, "{\"success\":true}");
+            
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
-    }
-};
-
-string getString(const crow::json::rvalue& val) {
-    return string(val.s());
-}
-
-string hashPassword(const string& password) {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, password.c_str(), password.size());
-    SHA256_Final(hash, &sha256);
+    });
     
-    stringstream ss;
-    for(int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        ss << hex << setw(2) << setfill('0') << (int)hash[i];
-    }
-    return ss.str();
-}
-
-string generateToken(const string& userId, const string& role) {
-    return userId + ":" + role + ":" + to_string(time(nullptr));
-}
-
-string getStringValue(const bsoncxx::document::element& elem) {
-    if(elem && elem.type() == bsoncxx::type::k_string) {
-        return string(elem.get_string().value);
-    }
-    return "";
-}
-
-int getIntValue(const bsoncxx::document::element& elem) {
-    if(elem && elem.type() == bsoncxx::type::k_int32) {
-        return elem.get_int32().value;
-    }
-    return 0;
-}
 
-double getDoubleValue(const bsoncxx::document::element& elem) {
-    if(elem && elem.type() == bsoncxx::type::k_double) {
-        return elem.get_double().value;
+    // ========================================================================
+// DOCTORS - UPDATE PROFILE (NEW!)
+// ========================================================================
+CROW_ROUTE(app, "/api/doctors/<string>").methods("PUT"_method)
+([&app, &pool, &identityCache, &doctorRoster](const crow::request& req, string doctorId) {
+    auto& session = app.get_context<AuthMiddleware>(req);
+    if(session.role != "admin" && session.role != "doctor") {
+        return crow::response(403, "{\"error\":\"Not allowed to edit doctor profiles\"}");
     }
-    return 0.0;
-}
-
-string getCurrentTimestamp() {
-    time_t now = time(0);
-    char timestamp[20];
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
-    return string(timestamp);
-}
-
-// ============================================================================
-// MAIN APPLICATION
-// ============================================================================
-
-int main() {
-    crow::App<CORSMiddleware> app;
     
-    // DSA Data Structures
-    auto patientList = make_shared<LinkedList<PatientRecord>>();
-    auto appointmentQueue = make_shared<CustomQueue<AppointmentRecord>>();
-    auto walletUpdateStack = make_shared<CustomStack<WalletUpdate>>();
+    auto x = crow::json::load(req.body);
+    if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
     
-    // THREAD-SAFE MongoDB Connection Pool
-    mongocxx::instance instance{};
-    mongocxx::uri uri{"mongodb://localhost:27017"};
-    mongocxx::pool pool{uri};
+    try {
+        auto client_conn = pool.acquire();
+        auto db = (*client_conn)["hospital_management"];
+        
+        string department = getString(x["department"]);
+        string specialization = getString(x["specialization"]);
+        int experience = x["experience"].i();
+        
+        // find_one_and_update hands back the userId in the same round trip
+        // so the identity cache entry can be dropped
+        mongocxx::options::find_one_and_update opts;
+        opts.projection(document{} << "userId" << 1 << finalize);
+        
+        // Doctors can only match their own profile
+        auto filterBuilder = document{};
+        filterBuilder << "_id" << bsoncxx::oid(doctorId);
+        if(session.role == "doctor") filterBuilder << "userId" << session.userId;
+        
+        auto doctors = db["doctors"];
+        auto doctorDoc = doctors.find_one_and_update(
+            filterBuilder.view(),
+            document{} << "$set" << open_document
+                << "department" << department
+                << "specialization" << specialization
+                << "experience" << experience
+            << close_document << finalize,
+            opts
+        );
+        
+        if(!doctorDoc) {
+            return crow::response(404, "{\"error\":\"Doctor not found\"}");
+        }
+        identityCache->invalidate(getStringValue(doctorDoc->view()["userId"]));
+        doctorRoster->invalidate();
+        
+        return crow::response(200, "{\"success\":true}");
+        
+    } catch(const exception& e) {
+        return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+    }
+});
 
     
-    CROW_LOG_INFO << "========================================";
-    CROW_LOG_INFO << "Hospital Management System - DSA Active";
-    CROW_LOG_INFO << "Custom: LinkedList, Queue, Stack, BST, Heap";
-    CROW_LOG_INFO << "Algorithms: QuickSort, MergeSort, BinarySearch";
-    CROW_LOG_INFO << "MongoDB: Thread-Safe Connection Pool";
-    CROW_LOG_INFO << "========================================";
-    
     // ========================================================================
-    // REGISTER
+    // DOCTOR SCHEDULE - PUT
     // ========================================================================
-    CROW_ROUTE(app, "/api/register").methods("POST"_method)
-    ([&pool, &patientList](const crow::request& req) {
+    CROW_ROUTE(app, "/api/doctors/<string>/schedule").methods("PUT"_method)
+    ([&app, &pool, &doctorRoster](const crow::request& req, string doctorId) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role != "admin" && session.role != "doctor") {
+            return crow::response(403, "{\"error\":\"Not allowed to edit doctor schedules\"}");
+        }
+        
         auto x = crow::json::load(req.body);
         if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
         
@@ -653,171 +4042,232 @@ int main() {
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            string email = getString(x["email"]);
-            string password = getString(x["password"]);
-            string role = getString(x["role"]);
-            string name = getString(x["name"]);
+            auto scheduleBuilder = document{};
+            auto scheduleArray = scheduleBuilder << "schedule" << open_array;
             
-            auto users = db["users"];
-            if(users.find_one(document{} << "email" << email << finalize)) {
-                return crow::response(409, "{\"error\":\"User already exists\"}");
+            for(auto& day : x["schedule"]) {
+                string dayName = getString(day["day"]);
+                string hours = getString(day["hours"]);
+                int startMinute, endMinute;
+                if(!scheduleDayBits(dayName)) {
+                    return crow::response(400, "{\"error\":\"Unknown schedule day: " + dayName + "\"}");
+                }
+                if(!parseScheduleHours(hours, startMinute, endMinute)) {
+                    return crow::response(400, "{\"error\":\"Hours for " + dayName +
+                        " must look like 9:00 AM - 5:00 PM or Closed\"}");
+                }
+                
+                scheduleArray << open_document
+                    << "day" << dayName
+                    << "hours" << hours
+                    << "startMinute" << startMinute
+                    << "endMinute" << endMinute
+                    << close_document;
             }
+            scheduleArray << close_array;
             
-            auto userDoc = document{} 
-                << "email" << email
-                << "password" << hashPassword(password)
-                << "role" << role
-                << "name" << name
-                << finalize;
+            // Doctors can only match their own profile
+            auto filterBuilder = document{};
+            filterBuilder << "_id" << bsoncxx::oid(doctorId);
+            if(session.role == "doctor") filterBuilder << "userId" << session.userId;
             
-            auto result = users.insert_one(userDoc.view());
-            string userId = result->inserted_id().get_oid().value.to_string();
+            auto doctors = db["doctors"];
+            auto result = doctors.update_one(
+                filterBuilder.view(),
+                document{} << "$set" << scheduleBuilder.view() << finalize
+            );
+            if(!result || result->matched_count() == 0) {
+                return crow::response(404, "{\"error\":\"Doctor not found\"}");
+            }
+            doctorRoster->invalidate();
             
-            db["wallets"].insert_one(document{}
-                << "userId" << userId
-                << "balance" << 0.0
-                << "transactions" << open_array << close_array
-                << finalize);
+            return crow::response(200, "{\"success\":true}");
             
-            if(role == "doctor") {
-                db["doctors"].insert_one(document{}
-                    << "userId" << userId
-                    << "name" << name
-                    << "email" << email
-                    << "department" << "General"
-                    << "specialization" << "General Practice"
-                    << "experience" << 0
-                    << "schedule" << open_array << close_array
-                    << finalize);
-            } else if(role == "patient") {
-                auto patDoc = db["patients"].insert_one(document{}
-                    << "userId" << userId
-                    << "name" << name
-                    << "email" << email
-                    << "age" << 0
-                    << "gender" << "not specified"
-                    << "phone" << ""
-                    << "address" << ""
-                    << finalize);
-                
-                PatientRecord pr;
-                pr.id = patDoc->inserted_id().get_oid().value.to_string();
-                pr.userId = userId;
-                pr.name = name;
-                pr.email = email;
-                pr.age = 0;
-                pr.gender = "not specified";
-                patientList->insertAtEnd(pr);
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // AVAILABILITY - EARLIEST FREE SLOTS (DSA: Bitset intersection)
+    // ========================================================================
+    CROW_ROUTE(app, "/api/availability").methods("GET"_method)
+    ([&pool, &doctorRoster, &slotIndex](const crow::request& req) {
+        try {
+            string department = req.url_params.get("department") ? req.url_params.get("department") : "";
+            
+            time_t now = time(nullptr);
+            char today[11];
+            strftime(today, sizeof(today), "%Y-%m-%d", localtime(&now));
+            
+            string from = req.url_params.get("from") ? req.url_params.get("from") : today;
+            if(!isIsoDate(from)) return crow::response(400, "{\"error\":\"from must be YYYY-MM-DD\"}");
+            if(from < today) from = today;
+            
+            string lastDay = from;
+            for(int i = 1; i < AVAILABILITY_MAX_DAYS; i++) lastDay = nextIsoDate(lastDay);
+            string to;
+            if(req.url_params.get("to")) {
+                to = req.url_params.get("to");
+                if(!isIsoDate(to)) return crow::response(400, "{\"error\":\"to must be YYYY-MM-DD\"}");
+                if(to > lastDay) to = lastDay;
+            } else {
+                to = from;
+                for(int i = 1; i < AVAILABILITY_DEFAULT_DAYS; i++) to = nextIsoDate(to);
             }
             
-            crow::json::wvalue r;
-            r["success"] = true;
-            r["token"] = generateToken(userId, role);
-            r["userId"] = userId;
-            r["role"] = role;
-            r["name"] = name;
+            int limit = parsePageLimit(req);
             
-            crow::response res(201);
+            auto client_conn = pool.acquire();
+            auto db = (*client_conn)["hospital_management"];
+            auto snapshot = doctorRoster->current(db);
+            
+            auto slots = findOpenSlots(*snapshot, *slotIndex, department, from, to, limit);
+            
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("slots").beginArray();
+            for(auto& slot : slots) {
+                char time[6];
+                snprintf(time, sizeof(time), "%02d:%02d", slot.minute / 60, slot.minute % 60);
+                json.beginObject()
+                    .field("date", slot.date)
+                    .field("time", time)
+                    .field("doctorUserId", slot.doctor->userId)
+                    .field("doctorName", slot.doctor->name)
+                    .field("department", slot.doctor->department)
+                    .endObject();
+            }
+            json.endArray()
+                .field("from", from)
+                .field("to", to)
+                .field("slotMinutes", APPOINTMENT_SLOT_MINUTES)
+                .field("dsaUsed", "Bitset AND NOT (schedule & ~booked) per doctor-day - O(days x doctors)")
+                .endObject();
+            
+            crow::response res(200);
             res.set_header("Content-Type", "application/json");
-            res.write(r.dump());
+            res.write(body);
             return res;
-            
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
     
     // ========================================================================
-    // LOGIN
+    // DOCTORS - SEARCH BY ID (DSA: Binary Search)
     // ========================================================================
-    CROW_ROUTE(app, "/api/login").methods("POST"_method)
-    ([&pool](const crow::request& req) {
-        auto x = crow::json::load(req.body);
-        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+    CROW_ROUTE(app, "/api/doctors/search").methods("GET"_method)
+    ([&pool, &doctorRoster](const crow::request& req) {
+        auto searchId = req.url_params.get("id");
+        if(!searchId) {
+            return crow::response(400, "{\"error\":\"Search ID required\"}");
+        }
         
         try {
+            // Served from the roster snapshot; Mongo is only read when the
+            // roster has been invalidated by a doctor write
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
+            auto snapshot = doctorRoster->current(db);
             
-            string email = getString(x["email"]);
-            string password = getString(x["password"]);
-            
-            auto users = db["users"];
-            auto userDoc = users.find_one(document{} << "email" << email << finalize);
-            
-            if(!userDoc || getStringValue(userDoc->view()["password"]) != hashPassword(password)) {
-                return crow::response(401, "{\"error\":\"Invalid credentials\"}");
+            const DoctorEntry* doctor = findDoctorById(*snapshot, searchId);
+            if(!doctor) {
+                return crow::response(404, "{\"error\":\"Doctor not found\"}");
             }
             
-            auto view = userDoc->view();
-            string userId = view["_id"].get_oid().value.to_string();
-            string role = getStringValue(view["role"]);
-            string name = getStringValue(view["name"]);
+            crow::json::wvalue d;
+            d["id"] = doctor->id;
+            d["userId"] = doctor->userId;
+            d["name"] = doctor->name;
+            d["email"] = doctor->email;
+            d["department"] = doctor->department;
+            d["specialization"] = doctor->specialization;
+            d["experience"] = doctor->experience;
             
             crow::json::wvalue r;
-            r["success"] = true;
-            r["token"] = generateToken(userId, role);
-            r["userId"] = userId;
-            r["role"] = role;
-            r["name"] = name;
+            r["doctor"] = std::move(d);
+            r["dsaUsed"] = "Doctor Roster Snapshot + Binary Search by id - O(log n)";
             
             crow::response res(200);
             res.set_header("Content-Type", "application/json");
             res.write(r.dump());
             return res;
-            
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
     
     // ========================================================================
-    // PATIENTS - GET ALL (DSA: Linked List)
+    // APPOINTMENTS - GET ALL (keyset paginated on date, time, _id)
     // ========================================================================
-    CROW_ROUTE(app, "/api/patients").methods("GET"_method)
-    ([&pool, &patientList](const crow::request& req) {
+    CROW_ROUTE(app, "/api/appointments").methods("GET"_method)
+    ([&app, &pool, &identityCache](const crow::request& req) {
         try {
+            auto& session = app.get_context<AuthMiddleware>(req);
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            auto patients = db["patients"];
-            crow::json::wvalue::list patientArray;
-            
-            patientList = make_shared<LinkedList<PatientRecord>>();
-            
-            for(auto&& doc : patients.find({})) {
-                PatientRecord pr;
-                pr.id = doc["_id"].get_oid().value.to_string();
-                pr.userId = getStringValue(doc["userId"]);
-                pr.name = getStringValue(doc["name"]);
-                pr.email = getStringValue(doc["email"]);
-                pr.age = getIntValue(doc["age"]);
-                pr.gender = getStringValue(doc["gender"]);
-                pr.phone = getStringValue(doc["phone"]);
-                pr.address = getStringValue(doc["address"]);
-                
-                patientList->insertAtEnd(pr);
-                
-                crow::json::wvalue p;
-                p["id"] = pr.id;
-                p["userId"] = pr.userId;
-                p["name"] = pr.name;
-                p["email"] = pr.email;
-                p["age"] = pr.age;
-                p["gender"] = pr.gender;
-                p["phone"] = pr.phone;
-                p["address"] = pr.address;
-                patientArray.push_back(std::move(p));
+            // Patients and doctors only ever list their own appointments; the
+            // owner filter comes from the token, not the query string
+            string ownerField;
+            if(session.role == "patient") ownerField = "patientUserId";
+            else if(session.role == "doctor") ownerField = "doctorUserId";
+            
+            // Push the dashboard filters down into Mongo so the
+            // doctorUserId / patientUserId / date indexes do the work
+            auto filterBuilder = document{};
+            if(!ownerField.empty()) filterBuilder << ownerField << session.userId;
+            const char* filterFields[] = {"doctorUserId", "patientUserId", "status", "date"};
+            for(const char* field : filterFields) {
+                if(ownerField == field) continue;
+                auto value = req.url_params.get(field);
+                if(value && *value) {
+                    filterBuilder << field << string(value);
+                }
             }
             
-            crow::json::wvalue r;
-            r["patients"] = std::move(patientArray);
-            r["dsaUsed"] = "Custom Linked List - O(n) traversal";
-            r["linkedListSize"] = patientList->size();
+            int limit = parsePageLimit(req);
+            
+            auto cursorParam = req.url_params.get("cursor");
+            if(cursorParam) {
+                vector<string> parts;
+                if(!decodeCursor(cursorParam, 3, parts)) {
+                    return crow::response(400, "{\"error\":\"Invalid cursor\"}");
+                }
+                filterBuilder << "$or" << open_array
+                    << open_document
+                        << "date" << open_document << "$gt" << parts[0] << close_document
+                    << close_document
+                    << open_document
+                        << "date" << parts[0]
+                        << "time" << open_document << "$gt" << parts[1] << close_document
+                    << close_document
+                    << open_document
+                        << "date" << parts[0]
+                        << "time" << parts[1]
+                        << "_id" << open_document << "$gt" << bsoncxx::oid(parts[2]) << close_document
+                    << close_document
+                << close_array;
+            }
+            
+            bool hasMore = false;
+            string nextCursor;
+            auto appointmentRecords = findAppointmentPage(db, filterBuilder.view(), limit, hasMore, nextCursor);
+            
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("appointments");
+            writeAppointments(json, db, *identityCache, appointmentRecords);
+            
+            json.field("hasMore", hasMore)
+                .field("nextCursor", nextCursor)
+                .field("dsaUsed", "Keyset Pagination + MergeSort on datetime keys - O(page)")
+                .endObject();
             
             crow::response res(200);
             res.set_header("Content-Type", "application/json");
-            res.write(r.dump());
+            res.write(body);
             return res;
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
@@ -825,10 +4275,15 @@ int main() {
     });
     
     // ========================================================================
-    // PATIENTS - POST (DSA: Linked List Insert)
+    // APPOINTMENTS - POST (DSA: Queue Enqueue)
     // ========================================================================
-    CROW_ROUTE(app, "/api/patients").methods("POST"_method)
-    ([&pool, &patientList](const crow::request& req) {
+    CROW_ROUTE(app, "/api/appointments").methods("POST"_method)
+    ([&app, &pool, &doctorQueues, &slotIndex](const crow::request& req) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(!isOfficeStaff(session) && session.role != "patient") {
+            return crow::response(403, "{\"error\":\"Only patients or reception staff can book appointments\"}");
+        }
+        
         auto x = crow::json::load(req.body);
         if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
         
@@ -836,60 +4291,68 @@ int main() {
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            string name = getString(x["name"]);
-            string email = getString(x["email"]);
-            string password = getString(x["password"]);
-            int age = x["age"].i();
-            string gender = getString(x["gender"]);
-            string phone = getString(x["phone"]);
-            string address = getString(x["address"]);
+            // Patients always book for themselves
+            string patientUserId = session.role == "patient" ? session.userId : getString(x["patientUserId"]);
+            string doctorUserId = getString(x["doctorUserId"]);
+            string date = getString(x["date"]);
+            string time = getString(x["time"]);
+            string reason = getString(x["reason"]);
             
-            auto users = db["users"];
-            if(users.find_one(document{} << "email" << email << finalize)) {
-                return crow::response(409, "{\"error\":\"User already exists\"}");
+            int32_t day;
+            int minute;
+            if(!isIsoDate(date) || !parseAppointmentSlot(date, time, day, minute)) {
+                return crow::response(400, "{\"error\":\"A valid date and time are required\"}");
             }
+            time = formatSlotTime(minute);
             
-            auto userDoc = document{} 
-                << "email" << email
-                << "password" << hashPassword(password)
-                << "role" << "patient"
-                << "name" << name
-                << finalize;
-            
-            auto result = users.insert_one(userDoc.view());
-            string userId = result->inserted_id().get_oid().value.to_string();
-            
-            auto patResult = db["patients"].insert_one(document{}
-                << "userId" << userId
-                << "name" << name
-                << "email" << email
-                << "age" << age
-                << "gender" << gender
-                << "phone" << phone
-                << "address" << address
-                << finalize);
-            
-            db["wallets"].insert_one(document{}
-                << "userId" << userId
-                << "balance" << 0.0
-                << "transactions" << open_array << close_array
-                << finalize);
-            
-            PatientRecord pr;
-            pr.id = patResult->inserted_id().get_oid().value.to_string();
-            pr.userId = userId;
-            pr.name = name;
-            pr.email = email;
-            pr.age = age;
-            pr.gender = gender;
-            pr.phone = phone;
-            pr.address = address;
-            patientList->insertAtEnd(pr);
+            bsoncxx::oid appointmentOid;
+            string appointmentId = appointmentOid.to_string();
+            string conflictId;
+            if(!slotIndex->reserve(doctorUserId, day, minute, appointmentId, conflictId)) {
+                crow::json::wvalue conflict;
+                conflict["error"] = "Doctor is already booked at this time";
+                conflict["conflictingAppointmentId"] = conflictId;
+                conflict["dsaUsed"] = "Ordered Interval Map - O(log n) overlap check";
+                
+                crow::response res(409);
+                res.set_header("Content-Type", "application/json");
+                res.write(conflict.dump());
+                return res;
+            }
+            
+            auto appointments = db["appointments"];
+            try {
+                appointments.insert_one(document{}
+                    << "_id" << appointmentOid
+                    << "patientUserId" << patientUserId
+                    << "doctorUserId" << doctorUserId
+                    << "date" << date
+                    << "time" << time
+                    << "reason" << reason
+                    << "status" << "pending"
+                    << "rejectionReason" << ""
+                    << finalize);
+            } catch(...) {
+                slotIndex->release(doctorUserId, day, minute, appointmentId);
+                throw;
+            }
+            
+            AppointmentRecord ar;
+            ar.id = appointmentId;
+            ar.patientUserId = patientUserId;
+            ar.doctorUserId = doctorUserId;
+            ar.date = date;
+            ar.time = time;
+            ar.reason = reason;
+            ar.status = "pending";
+            ar.dateTimeKey = makeDateTimeKey(date, time);
+            int queuePosition = doctorQueues->enqueue(ar);
             
             crow::json::wvalue r;
             r["success"] = true;
-            r["patientId"] = pr.id;
-            r["dsaUsed"] = "Linked List Insert - O(n)";
+            r["appointmentId"] = appointmentId;
+            r["queuePosition"] = queuePosition;
+            r["dsaUsed"] = "Interval Map Overlap Check - O(log n) + Per-Doctor Queue Enqueue - O(1)";
             
             crow::response res(201);
             res.set_header("Content-Type", "application/json");
@@ -900,36 +4363,110 @@ int main() {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
-
+    
     // ========================================================================
-    // PATIENTS - DELETE
+    // APPOINTMENTS - PUT (DSA: Indexed Queue Removal)
     // ========================================================================
-    CROW_ROUTE(app, "/api/patients/<string>").methods("DELETE"_method)
-    ([&pool, &patientList](const crow::request& req, string patientId) {
+    CROW_ROUTE(app, "/api/appointments/<string>").methods("PUT"_method)
+    ([&app, &pool, &doctorQueues, &slotIndex](const crow::request& req, string appointmentId) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role != "doctor" && session.role != "admin") {
+            return crow::response(403, "{\"error\":\"Only doctors can approve or reject appointments\"}");
+        }
+        
+        auto x = crow::json::load(req.body);
+        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+        
         try {
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            auto patients = db["patients"];
-            auto patientDoc = patients.find_one(document{} << "_id" << bsoncxx::oid(patientId) << finalize);
+            string status = x.has("status") ? getString(x["status"]) : "";
+            string rejectionReason = x.has("rejectionReason") ? getString(x["rejectionReason"]) : "";
             
-            if(!patientDoc) {
-                return crow::response(404, "{\"error\":\"Patient not found\"}");
+            if(status != "pending" && status != "approved" && status != "rejected") {
+                return crow::response(400, "{\"error\":\"status must be pending, approved or rejected\"}");
+            }
+            if(status == "rejected" && rejectionReason.empty()) {
+                return crow::response(400, "{\"error\":\"Rejection reason required\"}");
             }
             
-            string userId = getStringValue(patientDoc->view()["userId"]);
+            auto appointments = db["appointments"];
+            auto updateDoc = document{} 
+                << "$set" << open_document
+                    << "status" << status
+                    << "rejectionReason" << rejectionReason
+                << close_document
+                << finalize;
             
-            PatientRecord pr;
-            pr.id = patientId;
-            patientList->deleteByValue(pr);
+            // The pre-image gives the slot and the status being left
+            mongocxx::options::find_one_and_update opts;
+            opts.return_document(mongocxx::options::return_document::k_before);
+            opts.projection(document{} << "patientUserId" << 1 << "doctorUserId" << 1
+                << "date" << 1 << "time" << 1 << "reason" << 1
+                << "status" << 1 << "rejectionReason" << 1 << finalize);
             
-            patients.delete_one(document{} << "_id" << bsoncxx::oid(patientId) << finalize);
-            db["users"].delete_one(document{} << "_id" << bsoncxx::oid(userId) << finalize);
-            db["wallets"].delete_one(document{} << "userId" << userId << finalize);
+            // Doctors can only decide on their own appointments
+            auto filterBuilder = document{};
+            filterBuilder << "_id" << bsoncxx::oid(appointmentId);
+            if(session.role == "doctor") filterBuilder << "doctorUserId" << session.userId;
+            
+            auto before = appointments.find_one_and_update(
+                filterBuilder.view(),
+                updateDoc.view(),
+                opts
+            );
+            
+            if(!before) {
+                return crow::response(404, "{\"error\":\"Appointment not found\"}");
+            }
+            
+            auto old = before->view();
+            string oldStatus = getStringValue(old["status"]);
+            string doctorUserId = getStringValue(old["doctorUserId"]);
+            int32_t day;
+            int minute;
+            bool hasSlot = parseAppointmentSlot(getStringValue(old["date"]), getStringValue(old["time"]), day, minute);
+            
+            if(hasSlot && statusOccupiesSlot(oldStatus) && !statusOccupiesSlot(status)) {
+                slotIndex->release(doctorUserId, day, minute, appointmentId);
+            } else if(hasSlot && !statusOccupiesSlot(oldStatus) && statusOccupiesSlot(status)) {
+                // Reopening a rejected appointment needs its slot back
+                string conflictId;
+                if(!slotIndex->reserve(doctorUserId, day, minute, appointmentId, conflictId)) {
+                    // Only undo our own write: if another update has landed
+                    // since, its status stands
+                    appointments.update_one(
+                        document{} << "_id" << bsoncxx::oid(appointmentId) << "status" << status << finalize,
+                        document{} << "$set" << open_document
+                            << "status" << oldStatus
+                            << "rejectionReason" << getStringValue(old["rejectionReason"])
+                        << close_document << finalize
+                    );
+                    return crow::response(409, "{\"error\":\"Doctor is already booked at this time\"}");
+                }
+            }
+            
+            // Only pending appointments wait in the doctor's queue
+            if(oldStatus == "pending" && status != "pending") {
+                doctorQueues->remove(appointmentId);
+            } else if(oldStatus != "pending" && status == "pending") {
+                AppointmentRecord ar;
+                ar.id = appointmentId;
+                ar.patientUserId = getStringValue(old["patientUserId"]);
+                ar.doctorUserId = doctorUserId;
+                ar.date = getStringValue(old["date"]);
+                ar.time = getStringValue(old["time"]);
+                ar.reason = getStringValue(old["reason"]);
+                ar.status = status;
+                ar.dateTimeKey = makeDateTimeKey(ar.date, ar.time);
+                doctorQueues->enqueue(ar);
+            }
             
             crow::json::wvalue r;
             r["success"] = true;
-            r["dsaUsed"] = "Linked List Delete - O(n)";
+            r["dsaUsed"] = "Indexed Queue Removal by id (Fenwick tree) - O(log n)";
+            r["remainingInQueue"] = doctorQueues->size(doctorUserId);
             
             crow::response res(200);
             res.set_header("Content-Type", "application/json");
@@ -942,86 +4479,50 @@ int main() {
     });
     
     // ========================================================================
-// PATIENTS - UPDATE PROFILE (NEW!)
-// ========================================================================
-CROW_ROUTE(app, "/api/patients/<string>").methods("PUT"_method)
-([&pool](const crow::request& req, string patientId) {
-    auto x = crow::json::load(req.body);
-    if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
-    
-    try {
-        auto client_conn = pool.acquire();
-        auto db = (*client_conn)["hospital_management"];
-        
-        int age = x["age"].i();
-        string gender = getString(x["gender"]);
-        string phone = getString(x["phone"]);
-        string address = getString(x["address"]);
-        
-        auto patients = db["patients"];
-        auto result = patients.update_one(
-            document{} << "_id" << bsoncxx::oid(patientId) << finalize,
-            document{} << "$set" << open_document
-                << "age" << age
-                << "gender" << gender
-                << "phone" << phone
-                << "address" << address
-            << close_document << finalize
-        );
-        
-        if(result->modified_count() == 0) {
-            return crow::response(404, "{\"error\":\"Patient not found\"}");
-        }
-        
-        return crow::response(200, "{\"success\":true}");
-        
-    } catch(const exception& e) {
-        return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
-    }
-});
-    // ========================================================================
-    // DOCTORS - GET ALL (DSA: QuickSort)
+    // APPOINTMENT QUEUE STATUS
     // ========================================================================
-    CROW_ROUTE(app, "/api/doctors").methods("GET"_method)
-    ([&pool](const crow::request& req) {
+    CROW_ROUTE(app, "/api/appointments/queue/status").methods("GET"_method)
+    ([&doctorQueues](const crow::request& req) {
         try {
-            auto client_conn = pool.acquire();
-            auto db = (*client_conn)["hospital_management"];
-            
-            auto doctors = db["doctors"];
-            vector<crow::json::wvalue> doctorList;
-            
-            for(auto&& doc : doctors.find({})) {
-                crow::json::wvalue d;
-                d["id"] = doc["_id"].get_oid().value.to_string();
-                d["userId"] = getStringValue(doc["userId"]);
-                d["name"] = getStringValue(doc["name"]);
-                d["email"] = getStringValue(doc["email"]);
-                d["department"] = getStringValue(doc["department"]);
-                d["specialization"] = getStringValue(doc["specialization"]);
-                d["experience"] = getIntValue(doc["experience"]);
-                
-                crow::json::wvalue::list schedList;
-                if(doc["schedule"]) {
-                    for(auto&& s : doc["schedule"].get_array().value) {
-                        crow::json::wvalue sched;
-                        sched["day"] = getStringValue(s["day"]);
-                        sched["hours"] = getStringValue(s["hours"]);
-                        schedList.push_back(std::move(sched));
-                    }
-                }
-                d["schedule"] = std::move(schedList);
-                
-                doctorList.push_back(std::move(d));
+            crow::json::wvalue r;
+            auto doctorUserId = req.url_params.get("doctorUserId");
+            if(doctorUserId) {
+                r["doctorUserId"] = doctorUserId;
+                r["queueSize"] = doctorQueues->size(doctorUserId);
+            } else {
+                r["queueSize"] = doctorQueues->size();
             }
+            r["dsaUsed"] = "Per-Doctor Queue Size - O(1)";
             
-            if (!doctorList.empty()) {
-                quickSort(doctorList, 0, doctorList.size() - 1);
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(r.dump());
+            return res;
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    // ========================================================================
+    // APPOINTMENT QUEUE POSITION (DSA: Hash-Indexed Queue)
+    // ========================================================================
+    CROW_ROUTE(app, "/api/appointments/<string>/position").methods("GET"_method)
+    ([&app, &doctorQueues](const crow::request& req, string appointmentId) {
+        try {
+            auto& session = app.get_context<AuthMiddleware>(req);
+            DoctorQueues::Position place;
+            // Another patient's appointment answers like a missing one.
+            if(!doctorQueues->positionOf(appointmentId, place) ||
+               (session.role == "patient" && session.userId != place.patientUserId)) {
+                return crow::response(404, "{\"error\":\"Appointment is not waiting in a queue\"}");
             }
             
             crow::json::wvalue r;
-            r["doctors"] = std::move(doctorList);
-            r["dsaUsed"] = "QuickSort (Custom) - O(n log n)";
+            r["appointmentId"] = appointmentId;
+            r["doctorUserId"] = place.doctorUserId;
+            r["position"] = place.position;
+            r["queueSize"] = place.length;
+            r["dsaUsed"] = "Indexed Queue Position Lookup (Fenwick prefix sum) - O(log n)";
             
             crow::response res(200);
             res.set_header("Content-Type", "application/json");
@@ -1033,204 +4534,269 @@ CROW_ROUTE(app, "/api/patients/<string>").methods("PUT"_method)
     });
     
     // ========================================================================
-    // DOCTORS - POST
+    // EMERGENCY TRIAGE (DSA: Indexed Max-Heap)
     // ========================================================================
-    CROW_ROUTE(app, "/api/doctors").methods("POST"_method)
-    ([&pool](const crow::request& req) {
+    CROW_ROUTE(app, "/api/triage").methods("POST"_method)
+    ([&app, &pool, &identityCache, &triageQueue](const crow::request& req) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role == "patient") {
+            return crow::response(403, "{\"error\":\"Triage intake is done by hospital staff\"}");
+        }
+        
         auto x = crow::json::load(req.body);
         if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
         
         try {
+            TriageEntry entry;
+            entry.patientUserId = x.has("patientUserId") ? getString(x["patientUserId"]) : "";
+            entry.patientName = x.has("patientName") ? getString(x["patientName"]) : "";
+            entry.complaint = x.has("complaint") ? getString(x["complaint"]) : "";
+            if(!parseTriagePriority(x, entry.priority)) {
+                return crow::response(400, "{\"error\":\"priority must be a whole number from 1 (routine) to 5 (critical)\"}");
+            }
+            
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            string name = getString(x["name"]);
-            string email = getString(x["email"]);
-            string password = getString(x["password"]);
-            string department = getString(x["department"]);
-            string specialization = getString(x["specialization"]);
-            int experience = x["experience"].i();
-            
-            auto users = db["users"];
-            if(users.find_one(document{} << "email" << email << finalize)) {
-                return crow::response(409, "{\"error\":\"User already exists\"}");
+            if(entry.patientName.empty() && !entry.patientUserId.empty()) {
+                auto identities = resolveIdentities(db, *identityCache, {entry.patientUserId});
+                auto it = identities.find(entry.patientUserId);
+                if(it != identities.end()) entry.patientName = it->second.name;
+            }
+            if(entry.patientName.empty()) {
+                return crow::response(400, "{\"error\":\"patientName or a known patientUserId is required\"}");
             }
             
-            auto userDoc = document{} 
-                << "email" << email
-                << "password" << hashPassword(password)
-                << "role" << "doctor"
-                << "name" << name
-                << finalize;
-            
-            auto result = users.insert_one(userDoc.view());
-            string userId = result->inserted_id().get_oid().value.to_string();
-            
-            db["doctors"].insert_one(document{}
-                << "userId" << userId
-                << "name" << name
-                << "email" << email
-                << "department" << department
-                << "specialization" << specialization
-                << "experience" << experience
-                << "schedule" << open_array << close_array
-                << finalize);
+            entry.arrivalSeq = triageQueue->takeArrivalSeq();
+            entry.arrivedAt = getCurrentTimestamp();
             
-            db["wallets"].insert_one(document{}
-                << "userId" << userId
-                << "balance" << 0.0
-                << "transactions" << open_array << close_array
+            auto result = db["triage"].insert_one(document{}
+                << "patientUserId" << entry.patientUserId
+                << "patientName" << entry.patientName
+                << "complaint" << entry.complaint
+                << "priority" << entry.priority
+                << "arrivalSeq" << entry.arrivalSeq
+                << "arrivedAt" << entry.arrivedAt
+                << "status" << "waiting"
+                << "admittedBy" << session.userId
                 << finalize);
+            entry.id = result->inserted_id().get_oid().value.to_string();
+            triageQueue->admit(entry);
             
-            return crow::response(201, "{\"success\":true}");
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().field("success", true).key("entry");
+            writeTriageEntry(json, entry);
+            json.field("waiting", triageQueue->size())
+                .field("dsaUsed", "Indexed Max-Heap insert - O(log n)")
+                .endObject();
             
+            crow::response res(201);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
     
-    // ========================================================================
-    // DOCTORS - DELETE
-    // ========================================================================
-    CROW_ROUTE(app, "/api/doctors/<string>").methods("DELETE"_method)
-    ([&pool](const crow::request& req, string doctorId) {
+    CROW_ROUTE(app, "/api/triage").methods("GET"_method)
+    ([&app, &triageQueue](const crow::request& req) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role == "patient") {
+            return crow::response(403, "{\"error\":\"The triage board is for hospital staff\"}");
+        }
+        
         try {
-            auto client_conn = pool.acquire();
-            auto db = (*client_conn)["hospital_management"];
+            auto waiting = triageQueue->waiting();
             
-            auto doctors = db["doctors"];
-            auto doctorDoc = doctors.find_one(document{} << "_id" << bsoncxx::oid(doctorId) << finalize);
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("waiting").beginArray();
+            for(auto& entry : waiting) writeTriageEntry(json, entry);
+            json.endArray()
+                .field("count", (int)waiting.size())
+                .field("dsaUsed", "Indexed Max-Heap snapshot, sorted by priority then arrival - O(n log n)")
+                .endObject();
             
-            if(!doctorDoc) {
-                return crow::response(404, "{\"error\":\"Doctor not found\"}");
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    CROW_ROUTE(app, "/api/triage/<string>/priority").methods("PUT"_method)
+    ([&app, &pool, &triageQueue](const crow::request& req, string triageId) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role == "patient") {
+            return crow::response(403, "{\"error\":\"Only hospital staff can re-triage\"}");
+        }
+        
+        auto x = crow::json::load(req.body);
+        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+        int priority;
+        if(!parseTriagePriority(x, priority)) {
+            return crow::response(400, "{\"error\":\"priority must be a whole number from 1 (routine) to 5 (critical)\"}");
+        }
+        
+        try {
+            TriageEntry entry;
+            int previousPriority;
+            if(!triageQueue->reprioritize(triageId, priority, entry, previousPriority)) {
+                return crow::response(404, "{\"error\":\"Patient is not waiting in triage\"}");
             }
             
-            string userId = getStringValue(doctorDoc->view()["userId"]);
-            
-            doctors.delete_one(document{} << "_id" << bsoncxx::oid(doctorId) << finalize);
-            db["users"].delete_one(document{} << "_id" << bsoncxx::oid(userId) << finalize);
-            db["wallets"].delete_one(document{} << "userId" << userId << finalize);
+            try {
+                auto client_conn = pool.acquire();
+                auto db = (*client_conn)["hospital_management"];
+                db["triage"].update_one(
+                    document{} << "_id" << bsoncxx::oid(triageId) << "status" << "waiting" << finalize,
+                    document{} << "$set" << open_document << "priority" << priority << close_document << finalize
+                );
+            } catch(...) {
+                // Not persisted, so the heap goes back to the stored priority
+                triageQueue->revertPriority(triageId, priority, previousPriority);
+                throw;
+            }
             
-            return crow::response(200, "{\"success\":true}");
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().field("success", true).key("entry");
+            writeTriageEntry(json, entry);
+            json.field("dsaUsed", "Indexed Max-Heap increase/decrease-key - O(log n)")
+                .endObject();
             
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
     
-
-    // ========================================================================
-// DOCTORS - UPDATE PROFILE (NEW!)
-// ========================================================================
-CROW_ROUTE(app, "/api/doctors/<string>").methods("PUT"_method)
-([&pool](const crow::request& req, string doctorId) {
-    auto x = crow::json::load(req.body);
-    if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
-    
-    try {
-        auto client_conn = pool.acquire();
-        auto db = (*client_conn)["hospital_management"];
-        
-        string department = getString(x["department"]);
-        string specialization = getString(x["specialization"]);
-        int experience = x["experience"].i();
-        
-        auto doctors = db["doctors"];
-        auto result = doctors.update_one(
-            document{} << "_id" << bsoncxx::oid(doctorId) << finalize,
-            document{} << "$set" << open_document
-                << "department" << department
-                << "specialization" << specialization
-                << "experience" << experience
-            << close_document << finalize
-        );
-        
-        if(result->modified_count() == 0) {
-            return crow::response(404, "{\"error\":\"Doctor not found\"}");
+    CROW_ROUTE(app, "/api/triage/<string>").methods("DELETE"_method)
+    ([&app, &pool, &triageQueue](const crow::request& req, string triageId) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role == "patient") {
+            return crow::response(403, "{\"error\":\"Only hospital staff can discharge from triage\"}");
         }
         
-        return crow::response(200, "{\"success\":true}");
-        
-    } catch(const exception& e) {
-        return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
-    }
-});
-
-    
-    // ========================================================================
-    // DOCTOR SCHEDULE - PUT
-    // ========================================================================
-    CROW_ROUTE(app, "/api/doctors/<string>/schedule").methods("PUT"_method)
-    ([&pool](const crow::request& req, string doctorId) {
-        auto x = crow::json::load(req.body);
-        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
-        
         try {
-            auto client_conn = pool.acquire();
-            auto db = (*client_conn)["hospital_management"];
+            TriageEntry entry;
+            if(!triageQueue->remove(triageId, entry)) {
+                return crow::response(404, "{\"error\":\"Patient is not waiting in triage\"}");
+            }
             
-            auto scheduleBuilder = document{};
-            auto scheduleArray = scheduleBuilder << "schedule" << open_array;
+            bsoncxx::stdx::optional<mongocxx::result::update> closed;
+            try {
+                auto client_conn = pool.acquire();
+                auto db = (*client_conn)["hospital_management"];
+                closed = db["triage"].update_one(
+                    document{} << "_id" << bsoncxx::oid(triageId) << "status" << "waiting" << finalize,
+                    document{} << "$set" << open_document
+                        << "status" << "cancelled"
+                        << "closedAt" << getCurrentTimestamp()
+                        << "closedBy" << session.userId
+                        << close_document << finalize
+                );
+            } catch(...) {
+                // Still waiting in Mongo, so the patient keeps their place
+                triageQueue->admit(entry);
+                throw;
+            }
+            if(!closed || closed->matched_count() == 0) {
+                // Already called or discharged; the heap entry was stale
+                return crow::response(404, "{\"error\":\"Patient is not waiting in triage\"}");
+            }
             
-            for(auto& day : x["schedule"]) {
-                scheduleArray << open_document
-                    << "day" << getString(day["day"])
-                    << "hours" << getString(day["hours"])
-                    << close_document;
+            crow::json::wvalue r;
+            r["success"] = true;
+            r["waiting"] = triageQueue->size();
+            r["dsaUsed"] = "Indexed Max-Heap removal by id - O(log n)";
+            return crow::response(200, r.dump());
+        } catch(const exception& e) {
+            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+        }
+    });
+    
+    CROW_ROUTE(app, "/api/triage/next").methods("POST"_method)
+    ([&app, &pool, &triageQueue](const crow::request& req) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role != "doctor" && session.role != "admin") {
+            return crow::response(403, "{\"error\":\"Only doctors call the next triage patient\"}");
+        }
+        
+        try {
+            TriageEntry entry;
+            if(!triageQueue->next(entry)) {
+                return crow::response(404, "{\"error\":\"No patients waiting in triage\"}");
             }
-            scheduleArray << close_array;
             
-            auto doctors = db["doctors"];
-            doctors.update_one(
-                document{} << "_id" << bsoncxx::oid(doctorId) << finalize,
-                document{} << "$set" << scheduleBuilder.view() << finalize
-            );
+            try {
+                auto client_conn = pool.acquire();
+                auto db = (*client_conn)["hospital_management"];
+                db["triage"].update_one(
+                    document{} << "_id" << bsoncxx::oid(entry.id) << finalize,
+                    document{} << "$set" << open_document
+                        << "status" << "called"
+                        << "closedAt" << getCurrentTimestamp()
+                        << "closedBy" << session.userId
+                        << close_document << finalize
+                );
+            } catch(...) {
+                // Not recorded as called, so put the patient back in line
+                triageQueue->admit(entry);
+                throw;
+            }
             
-            return crow::response(200, "{\"success\":true}");
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("entry");
+            writeTriageEntry(json, entry);
+            json.field("waiting", triageQueue->size())
+                .field("dsaUsed", "Indexed Max-Heap extract-max - O(log n)")
+                .endObject();
             
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json");
+            res.write(body);
+            return res;
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
     
     // ========================================================================
-    // DOCTORS - SEARCH BY ID (DSA: Binary Search)
+    // WALLET - GET
     // ========================================================================
-    CROW_ROUTE(app, "/api/doctors/search").methods("GET"_method)
-    ([&pool](const crow::request& req) {
-        auto searchId = req.url_params.get("id");
-        if(!searchId) {
-            return crow::response(400, "{\"error\":\"Search ID required\"}");
+    CROW_ROUTE(app, "/api/wallet/<string>").methods("GET"_method)
+    ([&app, &pool](const crow::request& req, string userId) {
+        if(!canAccessWallet(app.get_context<AuthMiddleware>(req), userId)) {
+            return crow::response(403, "{\"error\":\"You can only view your own wallet\"}");
         }
         
         try {
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            auto doctors = db["doctors"];
-            auto doctorDoc = doctors.find_one(document{} << "_id" << bsoncxx::oid(searchId) << finalize);
-            
-            if(!doctorDoc) {
-                return crow::response(404, "{\"error\":\"Doctor not found\"}");
+            auto walletDoc = findWalletSummary(db, userId);
+            if(!walletDoc) {
+                return crow::response(404, "{\"error\":\"Wallet not found\"}");
             }
             
-            auto view = doctorDoc->view();
-            crow::json::wvalue d;
-            d["id"] = view["_id"].get_oid().value.to_string();
-            d["userId"] = getStringValue(view["userId"]);
-            d["name"] = getStringValue(view["name"]);
-            d["email"] = getStringValue(view["email"]);
-            d["department"] = getStringValue(view["department"]);
-            d["specialization"] = getStringValue(view["specialization"]);
-            d["experience"] = getIntValue(view["experience"]);
-            
-            crow::json::wvalue r;
-            r["doctor"] = std::move(d);
-            r["dsaUsed"] = "Binary Search - O(log n)";
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().field("userId", userId);
+            writeWalletSummary(json, walletDoc->view());
+            json.field("dsaUsed", "HashMap (O(1) lookup)").endObject();
             
             crow::response res(200);
             res.set_header("Content-Type", "application/json");
-            res.write(r.dump());
+            res.write(body);
             return res;
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
@@ -1238,77 +4804,81 @@ CROW_ROUTE(app, "/api/doctors/<string>").methods("PUT"_method)
     });
     
     // ========================================================================
-    // APPOINTMENTS - GET ALL (DSA: MergeSort)
+    // WALLET - TRANSACTION HISTORY (ledger, keyset paginated newest first)
     // ========================================================================
-    CROW_ROUTE(app, "/api/appointments").methods("GET"_method)
-    ([&pool](const crow::request& req) {
+    CROW_ROUTE(app, "/api/wallet/<string>/transactions").methods("GET"_method)
+    ([&app, &pool](const crow::request& req, string userId) {
+        if(!canAccessWallet(app.get_context<AuthMiddleware>(req), userId)) {
+            return crow::response(403, "{\"error\":\"You can only view your own wallet\"}");
+        }
+        
         try {
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            auto appointments = db["appointments"];
-            auto doctors = db["doctors"];
-            auto patients = db["patients"];
-            
-            vector<AppointmentRecord> appointmentRecords;
+            int limit = parsePageLimit(req);
+            auto filterBuilder = document{};
+            filterBuilder << "userId" << userId;
             
-            for(auto&& doc : appointments.find({})) {
-                AppointmentRecord ar;
-                ar.id = doc["_id"].get_oid().value.to_string();
-                ar.patientUserId = getStringValue(doc["patientUserId"]);
-                ar.doctorUserId = getStringValue(doc["doctorUserId"]);
-                ar.date = getStringValue(doc["date"]);
-                ar.time = getStringValue(doc["time"]);
-                ar.reason = getStringValue(doc["reason"]);
-                ar.status = getStringValue(doc["status"]);
-                ar.rejectionReason = getStringValue(doc["rejectionReason"]);
-                
-                appointmentRecords.push_back(ar);
+            auto cursorParam = req.url_params.get("cursor");
+            if(cursorParam) {
+                vector<string> parts;
+                if(!decodeCursor(cursorParam, 2, parts)) {
+                    return crow::response(400, "{\"error\":\"Invalid cursor\"}");
+                }
+                filterBuilder << "$or" << open_array
+                    << open_document
+                        << "timestamp" << open_document << "$lt" << parts[0] << close_document
+                    << close_document
+                    << open_document
+                        << "timestamp" << parts[0]
+                        << "_id" << open_document << "$lt" << bsoncxx::oid(parts[1]) << close_document
+                    << close_document
+                << close_array;
             }
             
-            if (!appointmentRecords.empty()) {
-                mergeSort(appointmentRecords, 0, appointmentRecords.size() - 1);
-            }
+            mongocxx::options::find opts;
+            opts.sort(document{} << "timestamp" << -1 << "_id" << -1 << finalize);
+            opts.limit(limit + 1);
             
-            crow::json::wvalue::list appointmentList;
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject()
+                .field("userId", userId)
+                .key("transactions").beginArray();
             
-            for(auto& ar : appointmentRecords) {
-                crow::json::wvalue a;
-                a["id"] = ar.id;
-                a["doctorUserId"] = ar.doctorUserId;
-                a["patientUserId"] = ar.patientUserId;
-                a["date"] = ar.date;
-                a["time"] = ar.time;
-                a["reason"] = ar.reason;
-                a["status"] = ar.status;
-                a["rejectionReason"] = ar.rejectionReason;
-                
-                auto doctorDoc = doctors.find_one(document{} << "userId" << ar.doctorUserId << finalize);
-                if(doctorDoc) {
-                    a["doctorName"] = getStringValue(doctorDoc->view()["name"]);
-                    a["department"] = getStringValue(doctorDoc->view()["department"]);
-                } else {
-                    a["doctorName"] = "Unknown";
-                    a["department"] = "Unknown";
+            int served = 0;
+            bool hasMore = false;
+            string lastTimestamp, lastId;
+            
+            for(auto&& doc : db["wallet_transactions"].find(filterBuilder.view(), opts)) {
+                if(served == limit) {
+                    hasMore = true;
+                    break;
                 }
                 
-                auto patientDoc = patients.find_one(document{} << "userId" << ar.patientUserId << finalize);
-                if(patientDoc) {
-                    a["patientName"] = getStringValue(patientDoc->view()["name"]);
-                } else {
-                    a["patientName"] = "Unknown";
-                }
+                lastId = doc["_id"].get_oid().value.to_string();
+                lastTimestamp = getStringValue(doc["timestamp"]);
                 
-                appointmentList.push_back(std::move(a));
+                json.beginObject()
+                    .field("id", lastId)
+                    .bsonDouble("amount", doc["amount"])
+                    .bsonString("type", doc["type"])
+                    .bsonString("description", doc["description"])
+                    .field("timestamp", lastTimestamp)
+                    .endObject();
+                served++;
             }
             
-            crow::json::wvalue r;
-            r["appointments"] = std::move(appointmentList);
-            r["dsaUsed"] = "MergeSort (Custom) - O(n log n)";
+            json.endArray()
+                .field("hasMore", hasMore)
+                .field("nextCursor", hasMore ? encodeCursor({lastTimestamp, lastId}) : "")
+                .field("dsaUsed", "Ledger Keyset Pagination on (userId, timestamp) index - O(page)")
+                .endObject();
             
             crow::response res(200);
             res.set_header("Content-Type", "application/json");
-            res.write(r.dump());
+            res.write(body);
             return res;
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
@@ -1316,10 +4886,10 @@ CROW_ROUTE(app, "/api/doctors/<string>").methods("PUT"_method)
     });
     
     // ========================================================================
-    // APPOINTMENTS - POST (DSA: Queue Enqueue)
+    // WALLET - POST (DSA: Stack Push) - THREAD-SAFE
     // ========================================================================
-    CROW_ROUTE(app, "/api/appointments").methods("POST"_method)
-    ([&pool, &appointmentQueue](const crow::request& req) {
+    CROW_ROUTE(app, "/api/wallet").methods("POST"_method)
+    ([&app, &pool, &walletJournal](const crow::request& req) {
         auto x = crow::json::load(req.body);
         if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
         
@@ -1327,95 +4897,148 @@ CROW_ROUTE(app, "/api/doctors/<string>").methods("PUT"_method)
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            string patientUserId = getString(x["patientUserId"]);
-            string doctorUserId = getString(x["doctorUserId"]);
-            string date = getString(x["date"]);
-            string time = getString(x["time"]);
-            string reason = getString(x["reason"]);
+            string userId = getString(x["userId"]);
+            double amount = x["amount"].d();
+            string type = getString(x["type"]);
+            string description = getString(x["description"]);
             
-            auto appointments = db["appointments"];
-            auto result = appointments.insert_one(document{}
-                << "patientUserId" << patientUserId
-                << "doctorUserId" << doctorUserId
-                << "date" << date
-                << "time" << time
-                << "reason" << reason
-                << "status" << "pending"
-                << "rejectionReason" << ""
-                << finalize);
+            auto& session = app.get_context<AuthMiddleware>(req);
+            if(type == "credit" && !isOfficeStaff(session)) {
+                return crow::response(403, "{\"error\":\"Only admin or receptionist can credit a wallet\"}");
+            }
+            if(!canAccessWallet(session, userId)) {
+                return crow::response(403, "{\"error\":\"You can only debit your own wallet\"}");
+            }
             
-            string appointmentId = result->inserted_id().get_oid().value.to_string();
+            if(!(amount > 0)) {
+                return crow::response(400, "{\"error\":\"Amount must be positive\"}");
+            }
             
-            AppointmentRecord ar;
-            ar.id = appointmentId;
-            ar.patientUserId = patientUserId;
-            ar.doctorUserId = doctorUserId;
-            ar.date = date;
-            ar.time = time;
-            ar.reason = reason;
-            ar.status = "pending";
-            appointmentQueue->enqueue(ar);
+            double delta = (type == "credit") ? amount : -amount;
+            string timestamp = getCurrentTimestamp();
+            
+            WalletUpdate update;
+            update.userId = userId;
+            update.operation = type + " " + to_string(amount);
+            update.timestamp = timestamp;
+            
+            // The balance change, its ledger row and its undo journal entry
+            // commit together
+            auto wallets = db["wallets"];
+            bsoncxx::stdx::optional<bsoncxx::document::value> walletDoc;
+            auto dbSession = client_conn->start_session();
+            dbSession.with_transaction([&](mongocxx::client_session* txn) {
+                walletDoc = applyWalletDelta(*txn, wallets, userId, delta,
+                    recentTransactionPush(amount, type, description, timestamp).view());
+                if(!walletDoc) return;
+                appendLedgerEntry(*txn, db, userId, amount, type, description, timestamp);
+                update.newBalance = getDoubleValue(walletDoc->view()["balance"]);
+                update.oldBalance = update.newBalance - delta;
+                walletJournal->persist(*txn, db, update);
+            });
+            
+            if(!walletDoc) {
+                if(!wallets.find_one(document{} << "userId" << userId << finalize)) {
+                    return crow::response(404, "{\"error\":\"Wallet not found\"}");
+                }
+                return crow::response(400, "{\"error\":\"Insufficient balance\"}");
+            }
+            
+            double newBalance = update.newBalance;
+            size_t journalDepth = walletJournal->push(db, update);
             
             crow::json::wvalue r;
             r["success"] = true;
-            r["appointmentId"] = appointmentId;
-            r["queuePosition"] = appointmentQueue->size();
-            r["dsaUsed"] = "Queue Enqueue - O(1)";
+            r["newBalance"] = newBalance;
+            r["dsaUsed"] = "Atomic $inc (single round trip) + Per-User Stack Push - O(1)";
+            r["stackSize"] = journalDepth;
             
-            crow::response res(201);
+            crow::response res(200);
             res.set_header("Content-Type", "application/json");
             res.write(r.dump());
             return res;
             
         } catch(const exception& e) {
+            CROW_LOG_ERROR << "Wallet POST error: " << e.what();
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
     
     // ========================================================================
-    // APPOINTMENTS - PUT (DSA: Queue Dequeue)
+    // WALLET - UNDO (DSA: Per-User Stack Pop) - THREAD-SAFE
     // ========================================================================
-    CROW_ROUTE(app, "/api/appointments/<string>").methods("PUT"_method)
-    ([&pool, &appointmentQueue](const crow::request& req, string appointmentId) {
+    CROW_ROUTE(app, "/api/wallet/undo").methods("POST"_method)
+    ([&app, &pool, &walletJournal](const crow::request& req) {
+        if(!isOfficeStaff(app.get_context<AuthMiddleware>(req))) {
+            return crow::response(403, "{\"error\":\"Only admin or receptionist can undo wallet operations\"}");
+        }
+        
         auto x = crow::json::load(req.body);
-        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+        if(!x || !x.has("userId")) {
+            return crow::response(400, "{\"error\":\"userId required\"}");
+        }
         
         try {
-            auto client_conn = pool.acquire();
-            auto db = (*client_conn)["hospital_management"];
-            
-            string status = getString(x["status"]);
-            string rejectionReason = x.has("rejectionReason") ? getString(x["rejectionReason"]) : "";
+            string userId = getString(x["userId"]);
             
-            if(status == "rejected" && rejectionReason.empty()) {
-                return crow::response(400, "{\"error\":\"Rejection reason required\"}");
+            WalletUpdate lastUpdate;
+            if(!walletJournal->pop(userId, lastUpdate)) {
+                return crow::response(400, "{\"error\":\"No operations to undo\"}");
             }
             
-            auto appointments = db["appointments"];
-            auto updateDoc = document{} 
-                << "$set" << open_document
-                    << "status" << status
-                    << "rejectionReason" << rejectionReason
-                << close_document
-                << finalize;
+            auto client_conn = pool.acquire();
+            auto db = (*client_conn)["hospital_management"];
             
-            auto result = appointments.update_one(
-                document{} << "_id" << bsoncxx::oid(appointmentId) << finalize,
-                updateDoc.view()
-            );
+            auto wallets = db["wallets"];
             
-            if(result->modified_count() == 0) {
-                return crow::response(404, "{\"error\":\"Appointment not found\"}");
+            // Reverse the original delta instead of restoring the old balance,
+            // so movements that landed after it are preserved
+            double undoDelta = lastUpdate.oldBalance - lastUpdate.newBalance;
+            double undoAmount = abs(undoDelta);
+            string undoDescription = "Undo: " + lastUpdate.operation;
+            string timestamp = getCurrentTimestamp();
+            
+            // The reversal, its ledger row and the journal entry's undone flag
+            // commit together. An entry that is already undone aborts the
+            // transaction, taking the reversal back out.
+            bsoncxx::stdx::optional<bsoncxx::document::value> walletDoc;
+            bool alreadyUndone = false;
+            auto dbSession = client_conn->start_session();
+            try {
+                dbSession.with_transaction([&](mongocxx::client_session* txn) {
+                    walletDoc = applyWalletDelta(*txn, wallets, lastUpdate.userId, undoDelta,
+                        recentTransactionPush(undoAmount, "undo", undoDescription, timestamp).view());
+                    if(!walletDoc) return;
+                    appendLedgerEntry(*txn, db, lastUpdate.userId, undoAmount, "undo", undoDescription, timestamp);
+                    if(!walletJournal->consume(*txn, db, lastUpdate, timestamp)) {
+                        alreadyUndone = true;
+                        throw runtime_error("wallet operation already undone");
+                    }
+                });
+            } catch(const exception&) {
+                if(!alreadyUndone) {
+                    walletJournal->restore(lastUpdate);
+                    throw;
+                }
             }
             
-            if(!appointmentQueue->isEmpty()) {
-                appointmentQueue->dequeue();
+            if(alreadyUndone) {
+                return crow::response(409, "{\"error\":\"Operation was already undone\"}");
+            }
+            if(!walletDoc) {
+                walletJournal->restore(lastUpdate);
+                return crow::response(409, "{\"error\":\"Wallet balance too low to undo\"}");
             }
             
+            walletJournal->commit(db, lastUpdate);
+            
             crow::json::wvalue r;
             r["success"] = true;
-            r["dsaUsed"] = "Queue Dequeue - O(1)";
-            r["remainingInQueue"] = appointmentQueue->size();
+            r["userId"] = lastUpdate.userId;
+            r["revertedBalance"] = getDoubleValue(walletDoc->view()["balance"]);
+            r["operation"] = lastUpdate.operation;
+            r["dsaUsed"] = "Per-User Stack Pop - O(1)";
+            r["remainingInStack"] = walletJournal->depth(userId);
             
             crow::response res(200);
             res.set_header("Content-Type", "application/json");
@@ -1423,23 +5046,64 @@ CROW_ROUTE(app, "/api/doctors/<string>").methods("PUT"_method)
             return res;
             
         } catch(const exception& e) {
+            CROW_LOG_ERROR << "Wallet UNDO error: " << e.what();
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
     
     // ========================================================================
-    // APPOINTMENT QUEUE STATUS
+    // WALLET HISTORY (DSA: Per-User Stack Traversal, paginated)
     // ========================================================================
-    CROW_ROUTE(app, "/api/appointments/queue/status").methods("GET"_method)
-    ([&appointmentQueue](const crow::request& req) {
+    CROW_ROUTE(app, "/api/wallet/history").methods("GET"_method)
+    ([&app, &walletJournal](const crow::request& req) {
+        auto userIdParam = req.url_params.get("userId");
+        if(!userIdParam || !*userIdParam) {
+            return crow::response(400, "{\"error\":\"userId required\"}");
+        }
+        if(!canAccessWallet(app.get_context<AuthMiddleware>(req), userIdParam)) {
+            return crow::response(403, "{\"error\":\"You can only view your own wallet history\"}");
+        }
+        
         try {
-            crow::json::wvalue r;
-            r["queueSize"] = appointmentQueue->size();
-            r["dsaUsed"] = "Queue Size - O(1)";
+            string userId = userIdParam;
+            int limit = parsePageLimit(req);
+            
+            string afterId;
+            auto cursorParam = req.url_params.get("cursor");
+            if(cursorParam) {
+                vector<string> parts;
+                if(!decodeCursor(cursorParam, 1, parts)) {
+                    return crow::response(400, "{\"error\":\"Invalid cursor\"}");
+                }
+                afterId = parts[0];
+            }
+            
+            bool hasMore = false;
+            auto history = walletJournal->page(userId, afterId, limit, hasMore);
+            
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject().key("history").beginArray();
+            for(auto& update : history) {
+                json.beginObject()
+                    .field("id", update.journalId)
+                    .field("userId", update.userId)
+                    .field("oldBalance", update.oldBalance)
+                    .field("newBalance", update.newBalance)
+                    .field("operation", update.operation)
+                    .field("timestamp", update.timestamp)
+                    .endObject();
+            }
+            json.endArray()
+                .field("historySize", (long long)walletJournal->depth(userId))
+                .field("hasMore", hasMore)
+                .field("nextCursor", hasMore ? encodeCursor({history.back().journalId}) : "")
+                .field("dsaUsed", "Per-User Stack Traversal - O(page)")
+                .endObject();
             
             crow::response res(200);
             res.set_header("Content-Type", "application/json");
-            res.write(r.dump());
+            res.write(body);
             return res;
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
@@ -1447,46 +5111,115 @@ CROW_ROUTE(app, "/api/doctors/<string>").methods("PUT"_method)
     });
     
     // ========================================================================
-    // WALLET - GET
+    // BULK IMPORT - PATIENTS / DOCTORS (NDJSON or CSV body)
     // ========================================================================
-    CROW_ROUTE(app, "/api/wallet/<string>").methods("GET"_method)
-    ([&pool](const crow::request& req, string userId) {
+    CROW_ROUTE(app, "/api/import/<string>").methods("POST"_method)
+    ([&app, &pool, &passwordHasher, &importLock, &patientIndex, &doctorRoster](const crow::request& req, string kind) {
+        if(kind != "patients" && kind != "doctors") {
+            return crow::response(404, "{\"error\":\"Unknown import kind\"}");
+        }
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(session.role != "admin" && session.role != "receptionist") {
+            return crow::response(403, "{\"error\":\"Imports require admin or receptionist\"}");
+        }
+        
+        unique_lock<mutex> running(*importLock, try_to_lock);
+        if(!running.owns_lock()) {
+            return crow::response(409, "{\"error\":\"Another import is already running\"}");
+        }
+        
         try {
-            auto client_conn = pool.acquire();
-            auto db = (*client_conn)["hospital_management"];
-            
-            auto wallets = db["wallets"];
-            auto walletDoc = wallets.find_one(document{} << "userId" << userId << finalize);
+            auto formatParam = req.url_params.get("format");
+            string format = formatParam ? formatParam : "";
+            if(format.empty()) {
+                format = req.get_header_value("Content-Type").find("csv") != string::npos ? "csv" : "ndjson";
+            }
+            if(format != "csv" && format != "ndjson") {
+                return crow::response(400, "{\"error\":\"format must be csv or ndjson\"}");
+            }
             
-            if(!walletDoc) {
-                return crow::response(404, "{\"error\":\"Wallet not found\"}");
+            int batchSize = DEFAULT_IMPORT_BATCH;
+            auto batchParam = req.url_params.get("batchSize");
+            if(batchParam && atoi(batchParam) > 0) {
+                batchSize = min(atoi(batchParam), MAX_IMPORT_BATCH);
             }
             
-            auto view = walletDoc->view();
-            crow::json::wvalue::list transList;
+            auto client_conn = pool.acquire();
+            
+            auto onImported = [&](const vector<PendingAccount*>& accounts) {
+                if(kind != "patients") return;
+                vector<PatientRecord> records;
+                records.reserve(accounts.size());
+                for(auto* account : accounts) {
+                    const ImportRow& f = account->fields;
+                    PatientRecord pr;
+                    pr.id = account->profileOid.to_string();
+                    pr.userId = account->userOid.to_string();
+                    pr.name = importField(f, "name");
+                    pr.email = importField(f, "email");
+                    pr.age = atoi(importField(f, "age", "0").c_str());
+                    pr.gender = importField(f, "gender", "not specified");
+                    pr.phone = importField(f, "phone");
+                    pr.address = importField(f, "address");
+                    records.push_back(std::move(pr));
+                }
+                patientIndex->upsertBatch(records);
+            };
+            
+            ImportReport report;
+            ImportReader reader(req.body, format == "csv");
+            vector<PendingAccount> batch;
+            batch.reserve(batchSize);
             
-            if(view["transactions"]) {
-                for(auto&& trans : view["transactions"].get_array().value) {
-                    crow::json::wvalue t;
-                    t["amount"] = getDoubleValue(trans["amount"]);
-                    t["type"] = getStringValue(trans["type"]);
-                    t["description"] = getStringValue(trans["description"]);
-                    t["timestamp"] = getStringValue(trans["timestamp"]);
-                    transList.push_back(std::move(t));
+            ImportRow row;
+            int rowNumber = 0;
+            string error;
+            while(reader.next(row, rowNumber, error)) {
+                if(error.empty()) error = validateImportRow(kind, row);
+                if(!error.empty()) {
+                    report.fail(rowNumber, error);
+                    continue;
+                }
+                
+                PendingAccount account;
+                account.row = rowNumber;
+                account.fields = std::move(row);
+                batch.push_back(std::move(account));
+                row = ImportRow();
+                
+                if((int)batch.size() == batchSize) {
+                    flushImportBatch(*client_conn, *passwordHasher, kind, batch, report, onImported);
                 }
             }
+            flushImportBatch(*client_conn, *passwordHasher, kind, batch, report, onImported);
             
-            double balance = getDoubleValue(view["balance"]);
+            if(kind == "doctors" && report.imported > 0) {
+                doctorRoster->invalidate();
+            }
             
-            crow::json::wvalue r;
-            r["userId"] = userId;
-            r["balance"] = balance;
-            r["transactions"] = std::move(transList);
-            r["dsaUsed"] = "HashMap (O(1) lookup)";
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject()
+                .field("imported", report.imported)
+                .field("failed", report.failed)
+                .field("batches", report.batches)
+                .field("batchSize", batchSize);
             
-            crow::response res(200);
+            json.key("errors").beginArray();
+            for(auto& failure : report.errors) {
+                json.beginObject()
+                    .field("row", failure.first)
+                    .field("error", failure.second)
+                    .endObject();
+            }
+            json.endArray()
+                .field("errorsTruncated", report.failed > (int)report.errors.size())
+                .field("dsaUsed", "Incremental row parser + batched insert_many per transaction")
+                .endObject();
+            
+            crow::response res(report.imported > 0 || report.failed == 0 ? 200 : 422);
             res.set_header("Content-Type", "application/json");
-            res.write(r.dump());
+            res.write(body);
             return res;
         } catch(const exception& e) {
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
@@ -1494,165 +5227,276 @@ CROW_ROUTE(app, "/api/doctors/<string>").methods("PUT"_method)
     });
     
     // ========================================================================
-    // WALLET - POST (DSA: Stack Push) - THREAD-SAFE
+    // REPORT EXPORT - APPOINTMENTS / TRANSACTIONS (NDJSON or CSV)
     // ========================================================================
-    CROW_ROUTE(app, "/api/wallet").methods("POST"_method)
-    ([&pool, &walletUpdateStack](const crow::request& req) {
-        auto x = crow::json::load(req.body);
-        if(!x) return crow::response(400, "{\"error\":\"Invalid JSON\"}");
+    CROW_ROUTE(app, "/api/export/<string>").methods("GET"_method)
+    ([&app, &pool, &activeExports](const crow::request& req, string kind) {
+        if(kind != "appointments" && kind != "transactions") {
+            return crow::response(404, "{\"error\":\"Unknown export kind\"}");
+        }
+        auto& session = app.get_context<AuthMiddleware>(req);
+        if(!isOfficeStaff(session)) {
+            return crow::response(403, "{\"error\":\"Exports require admin or receptionist\"}");
+        }
+        
+        string format = req.url_params.get("format") ? req.url_params.get("format") : "ndjson";
+        if(format != "csv" && format != "ndjson") {
+            return crow::response(400, "{\"error\":\"format must be csv or ndjson\"}");
+        }
+        string from = req.url_params.get("from") ? req.url_params.get("from") : "";
+        string to = req.url_params.get("to") ? req.url_params.get("to") : "";
+        if((!from.empty() && !isIsoDate(from)) || (!to.empty() && !isIsoDate(to))) {
+            return crow::response(400, "{\"error\":\"from and to must be YYYY-MM-DD\"}");
+        }
         
+        // The scan runs on this request thread; MAX_CONCURRENT_EXPORTS keeps
+        // exports from tying up more than a couple of Crow threads
+        if(++(*activeExports) > MAX_CONCURRENT_EXPORTS) {
+            (*activeExports)--;
+            crow::response busy(503, "{\"error\":\"Too many exports running, retry shortly\"}");
+            busy.set_header("Retry-After", "5");
+            return busy;
+        }
+        
+        string path;
         try {
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            string userId = getString(x["userId"]);
-            double amount = x["amount"].d();
-            string type = getString(x["type"]);
-            string description = getString(x["description"]);
-            
-            auto wallets = db["wallets"];
-            auto walletDoc = wallets.find_one(document{} << "userId" << userId << finalize);
-            
-            if(!walletDoc) {
-                return crow::response(404, "{\"error\":\"Wallet not found\"}");
+            bool appointments = kind == "appointments";
+            const char* dateField = appointments ? "date" : "timestamp";
+            auto filterBuilder = document{};
+            const vector<const char*> appointmentFilters = {"doctorUserId", "patientUserId", "status"};
+            const vector<const char*> transactionFilters = {"userId", "type"};
+            for(const char* field : appointments ? appointmentFilters : transactionFilters) {
+                auto value = req.url_params.get(field);
+                if(value && *value) filterBuilder << field << string(value);
             }
-            
-            double currentBalance = getDoubleValue(walletDoc->view()["balance"]);
-            double newBalance = (type == "credit") ? currentBalance + amount : currentBalance - amount;
-            
-            if(newBalance < 0) {
-                return crow::response(400, "{\"error\":\"Insufficient balance\"}");
+            if(!from.empty() || !to.empty()) {
+                // Ledger timestamps carry a time after the date, so the upper
+                // bound is the start of the following day
+                auto range = filterBuilder << dateField << open_document;
+                if(!from.empty()) range << "$gte" << from;
+                if(!to.empty()) {
+                    if(appointments) range << "$lte" << to;
+                    else range << "$lt" << nextIsoDate(to);
+                }
+                range << close_document;
             }
             
-            WalletUpdate update;
-            update.userId = userId;
-            update.oldBalance = currentBalance;
-            update.newBalance = newBalance;
-            update.operation = type + " " + to_string(amount);
-            update.timestamp = getCurrentTimestamp();
-            walletUpdateStack->push(update);
-            
-            auto transaction = document{}
-                << "amount" << amount
-                << "type" << type
-                << "description" << description
-                << "timestamp" << getCurrentTimestamp()
-                << finalize;
-            
-            wallets.update_one(
-                document{} << "userId" << userId << finalize,
-                document{} 
-                    << "$set" << open_document 
-                        << "balance" << newBalance 
-                    << close_document
-                    << "$push" << open_document
-                        << "transactions" << transaction.view()
-                    << close_document
-                << finalize
-            );
+            mongocxx::options::find opts;
+            opts.batch_size(EXPORT_CURSOR_BATCH);
+            if(appointments) {
+                opts.sort(document{} << "date" << 1 << "time" << 1 << "_id" << 1 << finalize);
+            } else {
+                opts.sort(document{} << "timestamp" << 1 << "_id" << 1 << finalize);
+            }
             
-            crow::json::wvalue r;
-            r["success"] = true;
-            r["newBalance"] = newBalance;
-            r["dsaUsed"] = "Stack Push - O(1)";
-            r["stackSize"] = walletUpdateStack->size();
+            path = newExportSpoolPath(kind, format);
+            ExportSpool spool(path, format == "csv",
+                              appointments ? APPOINTMENT_EXPORT_COLUMNS : TRANSACTION_EXPORT_COLUMNS);
+            auto source = db[appointments ? "appointments" : "wallet_transactions"];
+            for(auto&& doc : source.find(filterBuilder.view(), opts)) {
+                spool.write(doc);
+            }
+            size_t rows = spool.rowCount();
+            spool.close();
+            (*activeExports)--;
             
-            crow::response res(200);
-            res.set_header("Content-Type", "application/json");
-            res.write(r.dump());
+            crow::response res;
+            res.set_static_file_info_unsafe(path);
+            res.set_header("Content-Type", format == "csv" ? "text/csv" : "application/x-ndjson");
+            res.set_header("Content-Disposition", "attachment; filename=\"" + kind + "." + format + "\"");
+            res.set_header("X-Export-Rows", to_string(rows));
             return res;
-            
         } catch(const exception& e) {
-            CROW_LOG_ERROR << "Wallet POST error: " << e.what();
+            (*activeExports)--;
+            if(!path.empty()) remove(path.c_str());
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
     
     // ========================================================================
-    // WALLET - UNDO (DSA: Stack Pop) - THREAD-SAFE
+    // ME - BOOTSTRAP (a dashboard's initial state in one round trip)
     // ========================================================================
-    CROW_ROUTE(app, "/api/wallet/undo").methods("POST"_method)
-    ([&pool, &walletUpdateStack](const crow::request& req) {
+    CROW_ROUTE(app, "/api/me/bootstrap").methods("GET"_method)
+    ([&app, &pool, &patientIndex, &identityCache, &doctorQueues](const crow::request& req) {
+        auto& session = app.get_context<AuthMiddleware>(req);
+        string userId = session.userId;
+        string role = session.role;
+        
         try {
-            if(walletUpdateStack->isEmpty()) {
-                return crow::response(400, "{\"error\":\"No operations to undo\"}");
+            bool ownsWallet = role == "doctor" || role == "patient";
+            int limit = parsePageLimit(req);
+            
+            auto filter = document{};
+            if(role == "doctor") filter << "doctorUserId" << userId;
+            if(role == "patient") filter << "patientUserId" << userId;
+            
+            // The Mongo-backed sections are read concurrently, each on its own
+            // pooled client (mongocxx clients are not thread-safe), and render
+            // into their own fragment; this thread reads identity and profile
+            // meanwhile and splices the fragments in.
+            auto appointmentsTask = async(launch::async, [&]() {
+                auto conn = pool.acquire();
+                auto db = (*conn)["hospital_management"];
+                bool hasMore = false;
+                string nextCursor;
+                auto records = findAppointmentPage(db, filter.view(), limit, hasMore, nextCursor);
+                
+                string fragment;
+                JsonWriter section(fragment);
+                section.beginObject().key("appointments");
+                writeAppointments(section, db, *identityCache, records);
+                section.field("hasMore", hasMore)
+                    .field("nextCursor", nextCursor)
+                    .endObject();
+                return fragment;
+            });
+            
+            future<string> walletTask;
+            if(ownsWallet) {
+                walletTask = async(launch::async, [&]() {
+                    auto conn = pool.acquire();
+                    auto db = (*conn)["hospital_management"];
+                    string fragment;
+                    auto walletDoc = findWalletSummary(db, userId);
+                    if(walletDoc) {
+                        JsonWriter section(fragment);
+                        section.beginObject().field("userId", userId);
+                        writeWalletSummary(section, walletDoc->view());
+                        section.endObject();
+                    }
+                    return fragment;
+                });
+            }
+            
+            // A patient sees where each of their own waiting appointments
+            // stands, never the hospital-wide queue length
+            future<string> queueTask;
+            if(role == "patient") {
+                queueTask = async(launch::async, [&]() {
+                    auto conn = pool.acquire();
+                    auto db = (*conn)["hospital_management"];
+                    mongocxx::options::find opts;
+                    opts.projection(document{} << "_id" << 1 << finalize);
+                    
+                    string fragment;
+                    JsonWriter section(fragment);
+                    section.beginArray();
+                    auto pending = document{} << "patientUserId" << userId << "status" << "pending" << finalize;
+                    for(auto&& doc : db["appointments"].find(pending.view(), opts)) {
+                        string appointmentId = doc["_id"].get_oid().value.to_string();
+                        DoctorQueues::Position place;
+                        if(!doctorQueues->positionOf(appointmentId, place)) continue;
+                        section.beginObject()
+                            .field("appointmentId", appointmentId)
+                            .field("doctorUserId", place.doctorUserId)
+                            .field("position", place.position)
+                            .field("queueSize", place.length)
+                            .endObject();
+                    }
+                    section.endArray();
+                    return fragment;
+                });
             }
             
             auto client_conn = pool.acquire();
             auto db = (*client_conn)["hospital_management"];
             
-            WalletUpdate lastUpdate = walletUpdateStack->pop();
+            string& body = acquireResponseBuffer();
+            JsonWriter json(body);
+            json.beginObject();
             
-            auto wallets = db["wallets"];
+            auto identities = resolveIdentities(db, *identityCache, {userId});
+            auto it = identities.find(userId);
+            json.key("user").beginObject()
+                .field("userId", userId)
+                .field("role", role)
+                .field("name", it != identities.end() ? it->second.name : string(""))
+                .endObject();
             
-            wallets.update_one(
-                document{} << "userId" << lastUpdate.userId << finalize,
-                document{} 
-                    << "$set" << open_document 
-                        << "balance" << lastUpdate.oldBalance 
-                    << close_document
-                    << "$push" << open_document
-                        << "transactions" << open_document
-                            << "amount" << abs(lastUpdate.newBalance - lastUpdate.oldBalance)
-                            << "type" << "undo"
-                            << "description" << "Undo: " + lastUpdate.operation
-                            << "timestamp" << getCurrentTimestamp()
-                        << close_document
-                    << close_document
-                << finalize
-            );
+            json.key("profile");
+            if(role == "patient") {
+                auto pr = patientIndex->findByUserId(userId);
+                if(pr) writePatientProfile(json, *pr);
+                else json.nullValue();
+            } else if(role == "doctor") {
+                auto doctorDoc = findDoctorByUserId(db, userId);
+                if(doctorDoc) writeDoctorProfile(json, doctorDoc->view());
+                else json.nullValue();
+            } else {
+                json.nullValue();
+            }
             
-            crow::json::wvalue r;
-            r["success"] = true;
-            r["userId"] = lastUpdate.userId;
-            r["revertedBalance"] = lastUpdate.oldBalance;
-            r["operation"] = lastUpdate.operation;
-            r["dsaUsed"] = "Stack Pop - O(1)";
-            r["remainingInStack"] = walletUpdateStack->size();
+            json.key("appointments").raw(appointmentsTask.get());
+            
+            string wallet = ownsWallet ? walletTask.get() : string();
+            json.key("wallet");
+            if(!wallet.empty()) json.raw(wallet);
+            else json.nullValue();
+            
+            if(role == "patient") {
+                json.key("queuePositions").raw(queueTask.get());
+            } else {
+                json.field("queueSize", role == "doctor" ? doctorQueues->size(userId) : doctorQueues->size());
+            }
+            json.field("dsaUsed", "Snapshot Index + Keyset Page + Identity Cache, sections fanned out over the client pool")
+                .endObject();
             
             crow::response res(200);
             res.set_header("Content-Type", "application/json");
-            res.write(r.dump());
+            res.write(body);
             return res;
-            
         } catch(const exception& e) {
-            CROW_LOG_ERROR << "Wallet UNDO error: " << e.what();
             return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
         }
     });
     
     // ========================================================================
-    // WALLET HISTORY (DSA: Stack Traversal)
+    // IDENTITY CACHE STATS
     // ========================================================================
-    CROW_ROUTE(app, "/api/wallet/history").methods("GET"_method)
-    ([&walletUpdateStack](const crow::request& req) {
-        try {
-            crow::json::wvalue::list historyList;
-            
-            auto history = walletUpdateStack->toVector();
-            
-            for(auto& update : history) {
-                crow::json::wvalue h;
-                h["userId"] = update.userId;
-                h["oldBalance"] = update.oldBalance;
-                h["newBalance"] = update.newBalance;
-                h["operation"] = update.operation;
-                h["timestamp"] = update.timestamp;
-                historyList.push_back(std::move(h));
-            }
-            
-            crow::json::wvalue r;
-            r["history"] = std::move(historyList);
-            r["historySize"] = walletUpdateStack->size();
-            r["dsaUsed"] = "Stack Traversal - O(n)";
-            
-            crow::response res(200);
-            res.set_header("Content-Type", "application/json");
-            res.write(r.dump());
-            return res;
-        } catch(const exception& e) {
-            return crow::response(500, string("{\"error\":\"") + e.what() + "\"}");
+    CROW_ROUTE(app, "/api/cache/identity/stats").methods("GET"_method)
+    ([&app, &identityCache](const crow::request& req) {
+        if(app.get_context<AuthMiddleware>(req).role != "admin") {
+            return crow::response(403, "{\"error\":\"Admins only\"}");
+        }
+        
+        uint64_t hits = identityCache->hitCount();
+        uint64_t misses = identityCache->missCount();
+        
+        crow::json::wvalue r;
+        r["hits"] = hits;
+        r["misses"] = misses;
+        r["hitRate"] = (hits + misses) > 0 ? (double)hits / (hits + misses) : 0.0;
+        r["size"] = identityCache->size();
+        r["capacity"] = identityCache->capacity();
+        r["dsaUsed"] = "Sharded LRU HashMap - O(1) lookup";
+        
+        crow::response res(200);
+        res.set_header("Content-Type", "application/json");
+        res.write(r.dump());
+        return res;
+    });
+    
+    // ========================================================================
+    // PASSWORD HASHING METRICS
+    // ========================================================================
+    CROW_ROUTE(app, "/api/metrics/auth").methods("GET"_method)
+    ([&app, &passwordHasher](const crow::request& req) {
+        if(app.get_context<AuthMiddleware>(req).role != "admin") {
+            return crow::response(403, "{\"error\":\"Admins only\"}");
         }
+        
+        crow::json::wvalue r;
+        passwordHasher->writeStats(r);
+        r["kdf"] = "PBKDF2-HMAC-SHA256";
+        r["iterations"] = PBKDF2_ITERATIONS;
+        
+        crow::response res(200);
+        res.set_header("Content-Type", "application/json");
+        res.write(r.dump());
+        return res;
     });
     
   // ========================================================================
@@ -1665,7 +5509,7 @@ CROW_ROUTE(app, "/api/doctors/<string>").methods("PUT"_method)
     CROW_LOG_INFO << "Custom structures: ACTIVE ✓";
     CROW_LOG_INFO << "========================================";
     
-    app.port(8080).multithreaded().run();
+    app.port(8080).concurrency(serverThreads).run();
     
     return 0;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 import React, { useState, useEffect } from 'react';
+import axios from 'axios';
 import { BrowserRouter as Router, Routes, Route, Navigate } from 'react-router-dom';
 import Login from './components/Login';
 import Register from './components/Register';
@@ -19,16 +20,32 @@ function App() {
     const name = localStorage.getItem('name');
 
     if (token && role && userId) {
+      axios.defaults.headers.common['Authorization'] = `Bearer ${token}`;
       setUser({ token, role, userId, name });
     }
     setLoading(false);
   }, []);
 
+  useEffect(() => {
+    // Tokens are signed and expire; a 401 means the session is gone
+    const interceptor = axios.interceptors.response.use(
+      response => response,
+      error => {
+        if (error.response && error.response.status === 401) {
+          handleLogout();
+        }
+        return Promise.reject(error);
+      }
+    );
+    return () => axios.interceptors.response.eject(interceptor);
+  }, []);
+
   const handleLogin = (userData) => {
     localStorage.setItem('token', userData.token);
     localStorage.setItem('role', userData.role);
     localStorage.setItem('userId', userData.userId);
     localStorage.setItem('name', userData.name);
+    axios.defaults.headers.common['Authorization'] = `Bearer ${userData.token}`;
     setUser(userData);
   };
 
@@ -37,6 +54,7 @@ function App() {
     localStorage.removeItem('role');
     localStorage.removeItem('userId');
     localStorage.removeItem('name');
+    delete axios.defaults.headers.common['Authorization'];
     setUser(null);
   };
 
@@ -1,5 +1,6 @@
 import React, { useState, useEffect } from 'react';
 import axios from 'axios';
+import { fetchAllPages } from '../pagination';
 
 const API_URL = 'http://localhost:8080/api';
 
@@ -43,9 +44,21 @@ function AdminDashboard({ user, onLogout }) {
     fetchData();
   }, [activeTab]);
 
-  const fetchWalletHistory = async () => {
+  useEffect(() => {
+    if (activeTab === 'wallets') {
+      fetchWalletHistory(walletForm.userId);
+    }
+  }, [walletForm.userId]);
+
+  const fetchWalletHistory = async (userId = walletForm.userId) => {
+    if (!userId) {
+      setWalletHistory([]);
+      return;
+    }
     try {
-      const response = await axios.get(`${API_URL}/wallet/history`);
+      const response = await axios.get(`${API_URL}/wallet/history`, {
+        params: { userId, limit: 5 }
+      });
       setWalletHistory(response.data.history || []);
     } catch (error) {
       console.error('Error fetching wallet history:', error);
@@ -56,16 +69,16 @@ function AdminDashboard({ user, onLogout }) {
   const fetchData = async () => {
     setLoading(true);
     try {
-      const [doctorsRes, patientsRes, appointmentsRes] = await Promise.all([
-        axios.get(`${API_URL}/doctors`),
-        axios.get(`${API_URL}/patients`),
-        axios.get(`${API_URL}/appointments`)
+      const [doctorsData, patientsData, appointmentsData] = await Promise.all([
+        fetchAllPages(`${API_URL}/doctors`, 'doctors'),
+        fetchAllPages(`${API_URL}/patients`, 'patients'),
+        fetchAllPages(`${API_URL}/appointments`, 'appointments')
       ]);
       
-      setDoctors(doctorsRes.data.doctors || []);
-      setPatients(patientsRes.data.patients || []);
+      setDoctors(doctorsData.doctors || []);
+      setPatients(patientsData.patients || []);
       
-      const sortedAppointments = (appointmentsRes.data.appointments || []).sort((a, b) => {
+      const sortedAppointments = (appointmentsData.appointments || []).sort((a, b) => {
         const dateA = new Date(a.date + ' ' + a.time);
         const dateB = new Date(b.date + ' ' + b.time);
         return dateA - dateB;
@@ -152,13 +165,13 @@ function AdminDashboard({ user, onLogout }) {
     try {
       const response = await axios.post(`${API_URL}/wallet`, walletForm);
       setWalletForm({
-        userId: '',
+        userId: walletForm.userId,
         amount: 0,
         type: 'credit',
         description: ''
       });
       alert(`Wallet updated successfully!\n${response.data.dsaUsed || 'HashMap + Stack used'}`);
-      await fetchWalletHistory();
+      await fetchWalletHistory(walletForm.userId);
     } catch (error) {
       alert('Error updating wallet: ' + (error.response?.data?.error || error.message));
     }
@@ -167,7 +180,7 @@ function AdminDashboard({ user, onLogout }) {
   const handleUndoWallet = async () => {
     if (window.confirm('Are you sure you want to undo the last wallet operation?')) {
       try {
-        const response = await axios.post(`${API_URL}/wallet/undo`);
+        const response = await axios.post(`${API_URL}/wallet/undo`, { userId: walletForm.userId });
         alert(`Undo successful!\nUser: ${response.data.userId}\nReverted to: $${response.data.revertedBalance}\nDSA: ${response.data.dsaUsed}`);
         await fetchWalletHistory();
       } catch (error) {
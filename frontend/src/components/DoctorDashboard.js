@@ -1,5 +1,6 @@
-import React, { useState, useEffect } from 'react';
+import React, { useState, useEffect, useRef } from 'react';
 import axios from 'axios';
+import { fetchAllPages } from '../pagination';
 import '../Dashboard.css';
 
 const API_URL = 'http://localhost:8080/api';
@@ -28,47 +29,81 @@ function DoctorDashboard({ user, onLogout }) {
     experience: 0
   });
 
+  const bootstrapped = useRef(false);
+
   useEffect(() => {
+    // First load comes from one /me/bootstrap round trip; tab switches
+    // refresh only what that tab shows
+    if (!bootstrapped.current) {
+      bootstrapped.current = true;
+      fetchBootstrap();
+      return;
+    }
     fetchData();
     fetchQueueStatus();
   }, [activeTab]);
 
+  const fetchBootstrap = async () => {
+    setLoading(true);
+    try {
+      const { data } = await axios.get(`${API_URL}/me/bootstrap`);
+      applyDoctorProfile(data.profile);
+      const appointmentsData = await fetchAllPages(`${API_URL}/appointments`, 'appointments', {
+        doctorUserId: user.userId
+      }, data.appointments);
+      setAppointments(appointmentsData.appointments || []);
+      if (data.wallet) setWallet(data.wallet);
+      setQueueStatus(data.queueSize);
+      setDsaInfo(`DSA: ${data.dsaUsed}`);
+    } catch (error) {
+      console.error('Error fetching dashboard:', error);
+      fetchData();
+      fetchQueueStatus();
+    } finally {
+      setLoading(false);
+    }
+  };
+
   const fetchQueueStatus = async () => {
     try {
-      const response = await axios.get(`${API_URL}/appointments/queue/status`);
+      const response = await axios.get(`${API_URL}/appointments/queue/status`, {
+        params: { doctorUserId: user.userId }
+      });
       setQueueStatus(response.data.queueSize);
     } catch (error) {
       console.error('Error fetching queue status:', error);
     }
   };
 
+  const applyDoctorProfile = (doctor) => {
+    if (!doctor) return;
+    setDoctorProfile(doctor);
+    
+    // Set profile form
+    setProfileForm({
+      department: doctor.department || '',
+      specialization: doctor.specialization || '',
+      experience: doctor.experience || 0
+    });
+    
+    // Set schedule form
+    if (doctor.schedule && doctor.schedule.length > 0) {
+      const scheduleMap = {};
+      doctor.schedule.forEach(item => {
+        scheduleMap[item.day] = item.hours;
+      });
+      setScheduleForm({
+        weekday: scheduleMap['weekday'] || '9:00 AM - 5:00 PM',
+        saturday: scheduleMap['saturday'] || '9:00 AM - 1:00 PM',
+        sunday: scheduleMap['sunday'] || 'Closed'
+      });
+    }
+  };
+
   const fetchDoctorProfile = async () => {
     try {
-      const response = await axios.get(`${API_URL}/doctors`);
-      const doctor = response.data.doctors.find(d => d.userId === user.userId);
-      if (doctor) {
-        setDoctorProfile(doctor);
-        
-        // Set profile form
-        setProfileForm({
-          department: doctor.department || '',
-          specialization: doctor.specialization || '',
-          experience: doctor.experience || 0
-        });
-        
-        // Set schedule form
-        if (doctor.schedule && doctor.schedule.length > 0) {
-          const scheduleMap = {};
-          doctor.schedule.forEach(item => {
-            scheduleMap[item.day] = item.hours;
-          });
-          setScheduleForm({
-            weekday: scheduleMap['weekday'] || '9:00 AM - 5:00 PM',
-            saturday: scheduleMap['saturday'] || '9:00 AM - 1:00 PM',
-            sunday: scheduleMap['sunday'] || 'Closed'
-          });
-        }
-      }
+      const response = await axios.get(`${API_URL}/doctors/by-user/${user.userId}`);
+      applyDoctorProfile(response.data.doctor);
     } catch (error) {
       console.error('Error fetching doctor profile:', error);
     }
@@ -78,12 +113,11 @@ function DoctorDashboard({ user, onLogout }) {
     setLoading(true);
     try {
       if (activeTab === 'appointments') {
-        const response = await axios.get(`${API_URL}/appointments`);
-        const doctorAppointments = response.data.appointments.filter(
-          apt => apt.doctorUserId === user.userId
-        );
-        setAppointments(doctorAppointments);
-        setDsaInfo(`DSA: ${response.data.dsaUsed || 'MergeSort + Queue'}`);
+        const data = await fetchAllPages(`${API_URL}/appointments`, 'appointments', {
+          doctorUserId: user.userId
+        });
+        setAppointments(data.appointments || []);
+        setDsaInfo(`DSA: ${data.dsaUsed || 'MergeSort + Queue'}`);
       } else if (activeTab === 'wallet') {
         const response = await axios.get(`${API_URL}/wallet/${user.userId}`);
         setWallet(response.data);
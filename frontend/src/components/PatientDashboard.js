@@ -1,5 +1,6 @@
 import React, { useState, useEffect } from 'react';
 import axios from 'axios';
+import { fetchAllPages } from '../pagination';
 
 const API_URL = 'http://localhost:8080/api';
 
@@ -12,6 +13,8 @@ function PatientDashboard({ user, onLogout }) {
   const [searchTerm, setSearchTerm] = useState('');
   const [dsaInfo, setDsaInfo] = useState(null);
   const [patientProfile, setPatientProfile] = useState(null);
+  const [openSlots, setOpenSlots] = useState([]);
+  const [queuePositions, setQueuePositions] = useState({});
   
   const [appointmentForm, setAppointmentForm] = useState({
     doctorUserId: '',
@@ -31,10 +34,31 @@ function PatientDashboard({ user, onLogout }) {
     fetchData();
   }, [activeTab]);
 
+  useEffect(() => {
+    fetchOpenSlots(appointmentForm.doctorUserId);
+  }, [appointmentForm.doctorUserId]);
+
+  // Earliest free slots for the selected doctor, from the department search
+  const fetchOpenSlots = async (doctorUserId) => {
+    setOpenSlots([]);
+    const selectedDoctor = doctors.find(d => d.userId === doctorUserId);
+    if (!selectedDoctor) return;
+    try {
+      const response = await axios.get(`${API_URL}/availability`, {
+        params: { department: selectedDoctor.department, limit: 500 }
+      });
+      setOpenSlots((response.data.slots || [])
+        .filter(slot => slot.doctorUserId === doctorUserId)
+        .slice(0, 8));
+    } catch (error) {
+      console.error('Error fetching availability:', error);
+    }
+  };
+
   const fetchPatientProfile = async () => {
     try {
-      const response = await axios.get(`${API_URL}/patients`);
-      const patient = response.data.patients.find(p => p.userId === user.userId);
+      const response = await axios.get(`${API_URL}/patients/by-user/${user.userId}`);
+      const patient = response.data.patient;
       if (patient) {
         setPatientProfile(patient);
         setProfileForm({
@@ -49,25 +73,37 @@ function PatientDashboard({ user, onLogout }) {
     }
   };
 
+  // Place in the doctor's queue for each appointment still awaiting a decision
+  const fetchQueuePositions = async (appointmentList) => {
+    const pending = appointmentList.filter(apt => apt.status === 'pending');
+    const results = await Promise.all(pending.map(apt =>
+      axios.get(`${API_URL}/appointments/${apt.id}/position`)
+        .then(response => [apt.id, response.data.position])
+        .catch(() => [apt.id, null])
+    ));
+    setQueuePositions(Object.fromEntries(results.filter(([, position]) => position)));
+  };
+
   const fetchData = async () => {
     setLoading(true);
     try {
       if (activeTab === 'book') {
-        const response = await axios.get(`${API_URL}/doctors`);
-        setDoctors(response.data.doctors || []);
-        setDsaInfo(`DSA: ${response.data.dsaUsed || 'QuickSort applied'}`);
+        const data = await fetchAllPages(`${API_URL}/doctors`, 'doctors');
+        setDoctors(data.doctors || []);
+        setDsaInfo(`DSA: ${data.dsaUsed || 'QuickSort applied'}`);
       } else if (activeTab === 'appointments') {
-        const response = await axios.get(`${API_URL}/appointments`);
-        const patientAppointments = response.data.appointments.filter(
-          apt => apt.patientUserId === user.userId
-        );
+        const data = await fetchAllPages(`${API_URL}/appointments`, 'appointments', {
+          patientUserId: user.userId
+        });
+        const patientAppointments = data.appointments || [];
         const sorted = patientAppointments.sort((a, b) => {
           const dateA = new Date(a.date + ' ' + a.time);
           const dateB = new Date(b.date + ' ' + b.time);
           return dateA - dateB;
         });
         setAppointments(sorted);
-        setDsaInfo(`DSA: ${response.data.dsaUsed || 'MergeSort applied'}`);
+        setDsaInfo(`DSA: ${data.dsaUsed || 'MergeSort applied'}`);
+        fetchQueuePositions(sorted);
       } else if (activeTab === 'wallet') {
         const response = await axios.get(`${API_URL}/wallet/${user.userId}`);
         setWallet(response.data);
@@ -321,6 +357,24 @@ function PatientDashboard({ user, onLogout }) {
                           })()}
                         </div>
 
+                        {openSlots.length > 0 && (
+                          <div className="form-group">
+                            <label>Next Available</label>
+                            <div style={{ display: 'flex', flexWrap: 'wrap', gap: '8px' }}>
+                              {openSlots.map((slot, i) => (
+                                <button
+                                  key={i}
+                                  type="button"
+                                  className="btn-secondary"
+                                  onClick={() => setAppointmentForm({...appointmentForm, date: slot.date, time: slot.time})}
+                                >
+                                  {slot.date} {slot.time}
+                                </button>
+                              ))}
+                            </div>
+                          </div>
+                        )}
+
                         <div className="form-row">
                           <div className="form-group">
                             <label>Date *</label>
@@ -407,6 +461,11 @@ function PatientDashboard({ user, onLogout }) {
                                 <span className={`status ${appointment.status}`}>
                                   {appointment.status}
                                 </span>
+                                {queuePositions[appointment.id] && (
+                                  <small style={{ display: 'block', marginTop: '4px' }}>
+                                    #{queuePositions[appointment.id]} in queue
+                                  </small>
+                                )}
                               </td>
                             </tr>
                           ))}
@@ -1,5 +1,6 @@
-import React, { useState, useEffect } from 'react';
+import React, { useState, useEffect, useRef } from 'react';
 import axios from 'axios';
+import { fetchAllPages } from '../pagination';
 import '../Dashboard.css';
 
 const API_URL = 'http://localhost:8080/api';
@@ -32,11 +33,48 @@ function ReceptionistDashboard({ user, onLogout }) {
     reason: ''
   });
 
+  const bootstrapped = useRef(false);
+
   useEffect(() => {
+    // First load comes from one /me/bootstrap round trip (plus the
+    // directory listings); tab switches refresh only what that tab shows
+    if (!bootstrapped.current) {
+      bootstrapped.current = true;
+      fetchBootstrap();
+      return;
+    }
     fetchData();
     fetchQueueStatus();
   }, [activeTab]);
 
+  const fetchBootstrap = async () => {
+    setLoading(true);
+    try {
+      const [{ data }, patientsData, doctorsData] = await Promise.all([
+        axios.get(`${API_URL}/me/bootstrap`),
+        fetchAllPages(`${API_URL}/patients`, 'patients'),
+        fetchAllPages(`${API_URL}/doctors`, 'doctors')
+      ]);
+      const appointmentsData = await fetchAllPages(`${API_URL}/appointments`, 'appointments', {}, data.appointments);
+      const sorted = (appointmentsData.appointments || []).sort((a, b) => {
+        const dateA = new Date(a.date + ' ' + a.time);
+        const dateB = new Date(b.date + ' ' + b.time);
+        return dateA - dateB;
+      });
+      setAppointments(sorted);
+      setPatients(patientsData.patients || []);
+      setDoctors(doctorsData.doctors || []);
+      setQueueStatus(data.queueSize);
+      setDsaInfo(`DSA: ${data.dsaUsed}`);
+    } catch (error) {
+      console.error('Error fetching dashboard:', error);
+      fetchData();
+      fetchQueueStatus();
+    } finally {
+      setLoading(false);
+    }
+  };
+
   const fetchQueueStatus = async () => {
     try {
       const response = await axios.get(`${API_URL}/appointments/queue/status`);
@@ -50,24 +88,24 @@ function ReceptionistDashboard({ user, onLogout }) {
     setLoading(true);
     try {
       if (activeTab === 'appointments' || activeTab === 'activity') {
-        const response = await axios.get(`${API_URL}/appointments`);
+        const data = await fetchAllPages(`${API_URL}/appointments`, 'appointments');
         // Actually sort by date/time (MergeSort)
-        const sorted = (response.data.appointments || []).sort((a, b) => {
+        const sorted = (data.appointments || []).sort((a, b) => {
           const dateA = new Date(a.date + ' ' + a.time);
           const dateB = new Date(b.date + ' ' + b.time);
           return dateA - dateB;
         });
         setAppointments(sorted);
-        setDsaInfo(`DSA: ${response.data.dsaUsed || 'MergeSort + Queue'}`);
+        setDsaInfo(`DSA: ${data.dsaUsed || 'MergeSort + Queue'}`);
       }
       
       if (activeTab === 'register' || activeTab === 'schedule' || activeTab === 'activity') {
-        const [patientsRes, doctorsRes] = await Promise.all([
-          axios.get(`${API_URL}/patients`),
-          axios.get(`${API_URL}/doctors`)
+        const [patientsData, doctorsData] = await Promise.all([
+          fetchAllPages(`${API_URL}/patients`, 'patients'),
+          fetchAllPages(`${API_URL}/doctors`, 'doctors')
         ]);
-        setPatients(patientsRes.data.patients || []);
-        setDoctors(doctorsRes.data.doctors || []);
+        setPatients(patientsData.patients || []);
+        setDoctors(doctorsData.doctors || []);
       }
     } catch (error) {
       console.error('Error fetching data:', error);
@@ -120,15 +120,6 @@
                 placeholder="Confirm password"
                 />
             </div>
-            <div className="form-group">
-                <label>Role</label>
-                <select name="role" value={formData.role} onChange={handleChange}>
-                <option value="patient">Patient</option>
-                <option value="doctor">Doctor</option>
-                <option value="admin">Admin</option>
-                <option value="receptionist">Receptionist</option>
-                </select>
-            </div>
             <button type="submit" disabled={loading}>
                 {loading ? 'Registering...' : 'Register'}
             </button>
@@ -0,0 +1,20 @@
+import axios from 'axios';
+
+// List endpoints are keyset paginated; follow nextCursor until the server
+// reports no more pages and return the rows merged into one response shape.
+// A first page already in hand (e.g. from /me/bootstrap) can be passed in.
+export async function fetchAllPages(url, key, params = {}, firstPage = null) {
+  const items = firstPage ? [...(firstPage[key] || [])] : [];
+  let cursor = firstPage ? (firstPage.hasMore ? firstPage.nextCursor : null) : undefined;
+
+  while (cursor !== null) {
+    const response = await axios.get(url, {
+      params: cursor ? { ...params, cursor } : params
+    });
+    if (!firstPage) firstPage = response.data;
+    items.push(...(response.data[key] || []));
+    cursor = response.data.hasMore ? response.data.nextCursor : null;
+  }
+
+  return { ...firstPage, [key]: items, hasMore: false, nextCursor: '' };
+}
@@ -1,5 +1,17 @@
 
 
+// The backend creates accounts in multi-document transactions, which need a
+// replica set. Start mongod with --replSet rs0; a single node is enough.
+try {
+    rs.status();
+} catch (e) {
+    print("Initiating single-node replica set rs0...");
+    rs.initiate({ _id: "rs0", members: [{ _id: 0, host: "localhost:27017" }] });
+    while (rs.status().myState !== 1) {
+        sleep(200);
+    }
+}
+
 const db = db.getSiblingDB("hospital_management");
 
 // Drop existing collections to start fresh
@@ -12,6 +24,10 @@ db.doctors.drop();
 db.patients.drop();
 db.appointments.drop();
 db.wallets.drop();
+db.wallet_transactions.drop();
+db.wallet_undo_journal.drop();
+db.triage.drop();
+db.medical_records.drop();
 
 // Create collections
 print("Creating collections..."); 
@@ -20,6 +36,10 @@ db.createCollection('doctors');
 db.createCollection('patients');
 db.createCollection('appointments');
 db.createCollection('wallets');
+db.createCollection('wallet_transactions');
+db.createCollection('wallet_undo_journal');
+db.createCollection('triage');
+db.createCollection('medical_records');
 
 // Create indexes for better performance
 print("Creating indexes...");
@@ -29,11 +49,28 @@ db.patients.createIndex({ "userId": 1 });
 db.appointments.createIndex({ "patientUserId": 1 });
 db.appointments.createIndex({ "doctorUserId": 1 });
 db.appointments.createIndex({ "date": 1 });
+db.appointments.createIndex({ "date": 1, "time": 1, "_id": 1 });
+db.appointments.createIndex({ "doctorUserId": 1, "date": 1, "time": 1 });
+db.appointments.createIndex({ "patientUserId": 1, "date": 1, "time": 1 });
 db.wallets.createIndex({ "userId": 1 }, { unique: true });
+db.wallet_transactions.createIndex({ "userId": 1, "timestamp": -1, "_id": -1 });
+db.wallet_transactions.createIndex({ "timestamp": 1, "_id": 1 });
+db.wallet_undo_journal.createIndex({ "userId": 1, "_id": -1 });
+db.triage.createIndex({ "status": 1, "arrivalSeq": 1 });
+db.medical_records.createIndex({ "patientUserId": 1, "timestamp": 1, "_id": 1 });
+
+// Ledger timestamps use the server's local "YYYY-MM-DD HH:MM:SS" format so
+// seeded and live entries sort together
+function ledgerTimestamp(date) {
+    const pad = n => String(n).padStart(2, '0');
+    return date.getFullYear() + "-" + pad(date.getMonth() + 1) + "-" + pad(date.getDate()) + " " +
+        pad(date.getHours()) + ":" + pad(date.getMinutes()) + ":" + pad(date.getSeconds());
+}
 
 // Insert sample admin user
 // Password: admin123
 // SHA256 hash: 240be518fabd2724ddb6f04eeb1da5967448d7e831c08c8fa822809f74c720a9
+// (legacy format; the server rehashes it with PBKDF2 on first login)
 print("\nInserting admin user...");
 const adminResult = db.users.insertOne({
     email: "admin@hospital.com",
@@ -239,18 +276,19 @@ samplePatients.forEach(patient => {
     });
     
     // Create wallet with initial balance
+    const initialCredit = {
+        amount: 100.0,
+        type: "credit",
+        description: "Initial balance",
+        timestamp: ledgerTimestamp(new Date())
+    };
     db.wallets.insertOne({
         userId: userId,
         balance: 100.0,
-        transactions: [
-            {
-                amount: 100.0,
-                type: "credit",
-                description: "Initial balance",
-                timestamp: new Date().toISOString()
-            }
-        ]
+        transactions: [initialCredit],
+        ledgerMigrated: true
     });
+    db.wallet_transactions.insertOne(Object.assign({ userId: userId }, initialCredit));
     
     print("✓ Created patient: " + patient.name);
 });
@@ -350,6 +388,7 @@ print("   Doctors: " + db.doctors.countDocuments());
 print("   Patients: " + db.patients.countDocuments());
 print("   Appointments: " + db.appointments.countDocuments());
 print("   Wallets: " + db.wallets.countDocuments());
+print("   Wallet transactions: " + db.wallet_transactions.countDocuments());
 print("========================================");
 print("\n✅ All done! You can now start your application.");
 print("========================================\n");
\ No newline at end of file